@@ -0,0 +1,38 @@
+package longadder;
+
+import java.lang.Runnable;
+import java.util.concurrent.atomic.*;
+
+public class Counter implements Runnable {
+
+	public static final int OPS = 100;
+
+	AtomicInteger myint;
+	LongAdder     adder;
+
+	public Counter(boolean striped) {
+		if (striped)
+			adder = new LongAdder();
+		else
+			myint = new AtomicInteger();
+	}
+
+	public void run() {
+
+		if (adder != null) {
+			for (int i = 0; i < OPS; i++) {
+				adder.increment();
+			}
+		}
+		else {
+			for (int i = 0; i < OPS; i++) {
+				myint.getAndIncrement();
+			}
+		}
+	}
+
+	public long sum() {
+		return adder != null ? adder.sum() : myint.get();
+	}
+
+}
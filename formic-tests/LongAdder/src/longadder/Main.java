@@ -0,0 +1,54 @@
+package longadder;
+
+import java.lang.Thread;
+import java.util.concurrent.atomic.*;
+
+/**
+ * Increment a shared counter from an increasing number of threads,
+ * first on an AtomicInteger and then on a LongAdder, to compare how
+ * the two scale.
+ */
+
+public class Main {
+
+	public static void main(String[] args) throws InterruptedException {
+
+		int[]    tasks = { 1, 15, 63, 127, 255, 503 };
+		long     start, end;
+		Thread[] t;
+
+		System.out.println("Running LongAdder with " + Counter.OPS +
+		                   " increments per task");
+
+		for (int n = 0; n < tasks.length; n++) {
+			for (int kind = 0; kind < 2; kind++) {
+				Counter task = new Counter(kind == 1);
+
+				t = new Thread[tasks[n]];
+
+				for (int i = 0; i<t.length; i++) {
+					t[i] = new Thread(task);
+				}
+
+				start = System.currentTimeMillis();
+
+				for (int i = 0; i<t.length; i++) {
+					t[i].start();
+				}
+
+				for (int i = 0; i<t.length; i++) {
+					t[i].join();
+				}
+				end = System.currentTimeMillis();
+
+				System.out.println((kind == 1 ? "LongAdder" : "AtomicInteger") +
+				                   " with " + tasks[n] + " tasks took me " +
+				                   (end-start) + " ms, sum " + task.sum() +
+				                   " (expected " + tasks[n] * Counter.OPS + ")");
+			}
+		}
+
+		System.out.println("I am done");
+	}
+
+}
@@ -0,0 +1,59 @@
+package startall;
+
+import java.lang.Thread;
+
+/**
+ * Measure the time from starting an increasing number of threads
+ * until all of them run, first starting them one by one and then all
+ * at once with Thread.startAll.
+ */
+
+public class Main {
+
+	public static void main(String[] args) throws InterruptedException {
+
+		int[]    tasks = { 1, 15, 63, 127, 255, 503 };
+		long     start, running, end;
+		Thread[] t;
+
+		for (int n = 0; n < tasks.length; n++) {
+			for (int kind = 0; kind < 2; kind++) {
+				Worker task = new Worker();
+
+				t = new Thread[tasks[n]];
+
+				for (int i = 0; i<t.length; i++) {
+					t[i] = new Thread(task);
+				}
+
+				start = System.currentTimeMillis();
+
+				if (kind == 1) {
+					Thread.startAll(t);
+				} else {
+					for (int i = 0; i<t.length; i++) {
+						t[i].start();
+					}
+				}
+
+				while (task.running.get() < t.length) {
+					Thread.yield();
+				}
+				running = System.currentTimeMillis();
+
+				for (int i = 0; i<t.length; i++) {
+					t[i].join();
+				}
+				end = System.currentTimeMillis();
+
+				System.out.println((kind == 1 ? "startAll" : "start") +
+				                   " with " + tasks[n] + " tasks took me " +
+				                   (running-start) + " ms to run them all, " +
+				                   (end-start) + " ms to join them");
+			}
+		}
+
+		System.out.println("I am done");
+	}
+
+}
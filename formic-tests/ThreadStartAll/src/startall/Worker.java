@@ -0,0 +1,15 @@
+package startall;
+
+import java.lang.Runnable;
+import java.util.concurrent.atomic.*;
+
+public class Worker implements Runnable {
+
+	AtomicInteger running = new AtomicInteger();
+
+	public void run() {
+		// Only report that we run, in order to measure the spawn latency
+		running.getAndIncrement();
+	}
+
+}
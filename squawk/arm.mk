@@ -116,7 +116,8 @@ SQUAWK_OBJS:=$(addprefix $(BUILD_DIR)/obj/$(VM_SRC)/,$(SQUAWK_OBJS))
 ################################################################################
 FORMIC_OBJS =\
 	mmgr.arm.o \
-	mmp.arm.o
+	mmp.arm.o \
+	topology.arm.o
 FORMIC_OBJS:=$(addprefix $(BUILD_DIR)/obj/$(RTS_SRC)/,$(FORMIC_OBJS))
 ################################################################################
 
@@ -38,6 +38,7 @@ import javax.microedition.io.*;
 import com.sun.squawk.io.mailboxes.Mailbox;
 import com.sun.squawk.io.mailboxes.MailboxAddress;
 /*end[NEW_IIC_MESSAGES]*/
+import com.sun.squawk.platform.MMGR;
 import com.sun.squawk.platform.Platform;
 
 import com.sun.squawk.pragma.*;
@@ -265,9 +266,26 @@ public final class Isolate implements Runnable {
 /*end[ENABLE_CHANNEL_GUI]*/
 
     /**
-     * SquawkHashtable that holds the monitors for objects.
+     * The initial size of the monitors table, must be a power of two.
      */
-    private SquawkHashtable monitorHashtable = new SquawkHashtable();
+    private final static int MONITOR_TABLE_SIZE = 64;
+
+    /**
+     * The global addresses of the objects with monitors, the keys of an
+     * open-addressing table probed by {@link MMGR#monitorSlot}.  Empty
+     * slots hold 0.
+     */
+    private int[] monitorKeys = new int[MONITOR_TABLE_SIZE];
+
+    /**
+     * The monitors of the objects in the matching slots of monitorKeys.
+     */
+    private Monitor[] monitorTable = new Monitor[MONITOR_TABLE_SIZE];
+
+    /**
+     * The number of monitors in monitorTable.
+     */
+    private int monitorCount;
 
     /**
      * The translator that is to be used to locate, load and convert classes
@@ -718,31 +736,54 @@ public final class Isolate implements Runnable {
     /**
      * Get the monitor.
      *
+     * Monitors are keyed by the objects' global addresses, like in the
+     * monitor managers, so that the replies of the managers map back
+     * to their monitors without going through Object.hashCode().
+     *
+     * @param obj the object
      * @return the monitor
      */
     Monitor getMonitor(Object obj) {
         Monitor monitor;
-        // int objaddr  = Address.fromObject(obj).toUWord().toPrimitive();
+        int     slot;
 
-        // VM.print("get monitor for " + Integer.toHexString(objaddr) + "\n");
-        // objaddr = Address.fromObject(this).toUWord().toPrimitive();
-        // VM.print("This is " + Integer.toHexString(objaddr) + "\n");
-        // objaddr = Address.fromObject(monitorHashtable).toUWord().toPrimitive();
-        // VM.print("Hashtable is " + Integer.toHexString(objaddr) + "\n");
         Assert.that(obj != null);
-        Assert.that(monitorHashtable != null);
-        monitor = (Monitor)monitorHashtable.get(obj);
+        slot = MMGR.monitorSlot(monitorKeys, obj);
+        monitor = monitorTable[slot];
 
         if (monitor == null) {
             monitor = new Monitor(obj);
-            monitorHashtable.put(obj, monitor);
+            monitorKeys[slot] = Address.fromObject(obj).toUWord().toPrimitive();
+            monitorTable[slot] = monitor;
+
+            // Keep the load factor under 3/4 to keep the probes short
+            if (++monitorCount * 4 > monitorKeys.length * 3) {
+                growMonitorTable();
+            }
         }
-        // int monaddr  = Address.fromObject(monitor).toUWord().toPrimitive();
-        // VM.print("monitor is " + Integer.toHexString(monaddr) + "\n");
 
         return monitor;
     }
 
+    /**
+     * Double the size of the monitors table.
+     */
+    private void growMonitorTable() {
+        Monitor[] oldTable = monitorTable;
+
+        monitorKeys = new int[oldTable.length * 2];
+        monitorTable = new Monitor[oldTable.length * 2];
+
+        for (int i = 0; i < oldTable.length; i++) {
+            Monitor monitor = oldTable[i];
+            if (monitor != null) {
+                int slot = MMGR.monitorSlot(monitorKeys, monitor.object);
+                monitorKeys[slot] = Address.fromObject(monitor.object).toUWord().toPrimitive();
+                monitorTable[slot] = monitor;
+            }
+        }
+    }
+
     /**
      * Sets the translator.
      *
@@ -2247,6 +2247,7 @@ public class Klass<T> {
 			oopMapWord = UWord.zero();
 			dataMap = null;
 			//dataMapWord set in constructor
+			modifiers |= Modifier.KLASS_IMMUTABLE;
 			return;
 		}
 
@@ -2259,9 +2260,22 @@ public class Klass<T> {
 			dataMap       = superType.dataMap;
 			dataMapWord   = superType.dataMapWord;
 			dataMapLength = superType.dataMapLength;
+			modifiers    |= superType.modifiers & Modifier.KLASS_IMMUTABLE;
 			return;
 		}
 
+		// Instances are immutable if all the instance fields are final
+		if (superType.instanceSizeBytes == 0 ||
+		    Modifier.isImmutable(superType.modifiers)) {
+			int i = 0;
+			while (i != fields.length && fields[i].isFinal()) {
+				++i;
+			}
+			if (i == fields.length) {
+				modifiers |= Modifier.KLASS_IMMUTABLE;
+			}
+		}
+
 		// Set the field offsets
 		instanceSizeBytes = (short)initializeFieldOffsets(fields);
 
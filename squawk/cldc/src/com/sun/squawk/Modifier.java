@@ -633,6 +633,13 @@ public final class Modifier {
         return (mod & SUITE_PRIVATE) != 0;
     }
 
+    /**
+     * Return true if the instances of the class are immutable once published.
+     */
+    public static boolean isImmutable(int mod) {
+        return (mod & KLASS_IMMUTABLE) != 0;
+    }
+
     /*----------------------------- generic squawk modifiers-------------------------------*/
     
     /**
@@ -782,4 +789,12 @@ public final class Modifier {
      */
     public static final int SUITE_PRIVATE = 0x04000000;
 
+    /**
+     * The <code>int</code> value denoting that the instances of a class are
+     * immutable once published (strings and classes whose instance fields,
+     * including the inherited ones, are all final).  Such objects are kept
+     * in the read-only partition of the software cache.
+     */
+    public static final int KLASS_IMMUTABLE = 0x08000000;
+
 }
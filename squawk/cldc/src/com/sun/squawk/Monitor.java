@@ -80,6 +80,39 @@ public final class Monitor {
 	 */
 	final static int MONITOR_THRESHOLD = 5;
 
+	/**
+	 * Whether this core keeps the monitor after its last release (a
+	 * lease).  The monitor manager still considers us the owner, so
+	 * local threads can re-acquire it without contacting it, until
+	 * it revokes the lease.
+	 */
+	boolean leased;
+
+	/**
+	 * Whether the monitor manager asked us to give back the monitor,
+	 * because another core requested it.
+	 */
+	boolean revoked;
+
+	/**
+	 * Our current (or last) tenure of the monitor, as counted by the
+	 * monitor manager.  Used to tell stale revokes.
+	 */
+	int tenure;
+
+	/**
+	 * The tenure of a revoke that arrived before the grant it
+	 * refers to (0 if none).
+	 */
+	int revokedTenure;
+
+	/**
+	 * The core to hand the monitor to when revoked, packed as
+	 * (board_ID << 3) | (core_ID), or -1 to give it back to the
+	 * monitor manager.
+	 */
+	int successor;
+
 	/**
 	 * The object that this is a monitor for. Used for debugging/assertions.
 	 */
@@ -32,6 +32,7 @@ package com.sun.squawk;
 import java.util.Enumeration;
 import java.util.Hashtable;
 
+import com.sun.squawk.platform.MMP;
 import com.sun.squawk.pragma.*;
 import com.sun.squawk.util.*;
 import com.sun.squawk.vm.*;
@@ -52,24 +53,178 @@ public final class NativeUnsafe {
 	private NativeUnsafe() {}
 
 	/*-----------------------------------------------------------------------*\
-	 *                            Compare and swap                           *
+	 *                           Atomic primitives                           *
 	\*-----------------------------------------------------------------------*/
 
+	/**
+	 * The flags of atomic0 (see APMGR_* in apmgr.h)
+	 */
+	private final static int ATOMIC_WIDE = 1;
+	private final static int ATOMIC_REF  = 2;
+
+	/**
+	 * Requests an atomic primitive on a field of an object.  The
+	 * primitive is executed at the object's home core.  If that is
+	 * this core it is executed right away, otherwise the current thread
+	 * must wait for the reply, keyed by its address.  Either way the
+	 * previous value of the field ends up in the thread's atomicValue.
+	 *
+	 * @param op     the primitive (one of the MMP.OPS_AT_* requests)
+	 * @param base   the object
+	 * @param offset the offset (in words) of the field
+	 * @param arg0   the expected value (CAS), the addend (FAD) or the
+	 *               new value (SWAP and SET)
+	 * @param arg1   the new value (CAS)
+	 * @param flags  ATOMIC_WIDE for a long field, ATOMIC_REF for a
+	 *               reference field
+	 * @return true if the primitive was executed locally
+	 */
 	@Vm2c(proxy="")
-	public static boolean compareAndSwapInt0(Object base, int expect,
-	                                         int value) throws NativePragma {
-		return true;
+	public static boolean atomic0(int op, Object base, int offset, long arg0,
+	                              long arg1, int flags) throws NativePragma {
+		throw Assert.shouldNotReachHere("unimplemented when hosted");
+	}
+
+	/**
+	 * Executes an atomic primitive, blocking the current thread until
+	 * it completes.
+	 *
+	 * @see #atomic0
+	 * @return the previous value of the field
+	 */
+	private static long atomic(int op, Object base, int offset, long arg0,
+	                           long arg1, int flags) {
+		VMThread thread = VMThread.currentThread();
+
+		if (!atomic0(op, base, offset, arg0, arg1, flags)) {
+			VMThread.waitForEvent(
+			    Address.fromObject(thread).toUWord().toPrimitive());
+		}
+
+		return thread.getAtomicValue();
+	}
+
+	/**
+	 * @see Unsafe#compareAndSwapInt
+	 */
+	public static boolean compareAndSwapInt(Object base, int offset,
+	                                        int expect, int value) {
+		return (int)atomic(MMP.OPS_AT_CAS, base, offset, expect, value, 0) ==
+		       expect;
+	}
+
+	/**
+	 * @see Unsafe#getAndAddInt
+	 */
+	public static int getAndAddInt(Object base, int offset, int delta) {
+		return (int)atomic(MMP.OPS_AT_FAD, base, offset, delta, 0, 0);
+	}
+
+	/**
+	 * @see Unsafe#getAndSetInt
+	 */
+	public static int getAndSetInt(Object base, int offset, int value) {
+		return (int)atomic(MMP.OPS_AT_SWAP, base, offset, value, 0, 0);
+	}
+
+	/**
+	 * @see Unsafe#getIntVolatile
+	 */
+	public static int getIntVolatile(Object base, int offset) {
+		return (int)atomic(MMP.OPS_AT_GET, base, offset, 0, 0, 0);
+	}
+
+	/**
+	 * @see Unsafe#putIntVolatile
+	 */
+	public static void putIntVolatile(Object base, int offset, int value) {
+		atomic(MMP.OPS_AT_SET, base, offset, value, 0, 0);
+	}
+
+	/**
+	 * @see Unsafe#compareAndSwapLong
+	 */
+	public static boolean compareAndSwapLong(Object base, int offset,
+	                                         long expect, long value) {
+		return atomic(MMP.OPS_AT_CAS, base, offset, expect, value,
+		              ATOMIC_WIDE) == expect;
+	}
+
+	/**
+	 * @see Unsafe#getAndAddLong
+	 */
+	public static long getAndAddLong(Object base, int offset, long delta) {
+		return atomic(MMP.OPS_AT_FAD, base, offset, delta, 0, ATOMIC_WIDE);
+	}
+
+	/**
+	 * @see Unsafe#getAndSetLong
+	 */
+	public static long getAndSetLong(Object base, int offset, long value) {
+		return atomic(MMP.OPS_AT_SWAP, base, offset, value, 0, ATOMIC_WIDE);
+	}
+
+	/**
+	 * @see Unsafe#getLongVolatile
+	 */
+	public static long getLongVolatile(Object base, int offset) {
+		return atomic(MMP.OPS_AT_GET, base, offset, 0, 0, ATOMIC_WIDE);
+	}
+
+	/**
+	 * @see Unsafe#putLongVolatile
+	 */
+	public static void putLongVolatile(Object base, int offset, long value) {
+		atomic(MMP.OPS_AT_SET, base, offset, value, 0, ATOMIC_WIDE);
 	}
 
-	public static boolean compareAndSwapInt(Object base, int expect,
-	                                        int value) {
-		VMThread thread;
-		int event;
-		thread = VMThread.currentThread();
-		event = GC.getHashCode(base); /* FIXME: thread id and base combination */;
-		compareAndSwapInt0(base, expect, value);
-		VMThread.waitForEvent(event);
-		return thread.getResult() != null;
+	/**
+	 * Converts an object to the argument of an atomic primitive.
+	 */
+	private static long atomicRef(Object value) {
+		return Address.fromObject(value).toUWord().toPrimitive();
+	}
+
+	/**
+	 * Converts the result of an atomic primitive to an object.
+	 */
+	private static Object atomicObject(long value) {
+		return Address.fromPrimitive((int)value).toObject();
+	}
+
+	/**
+	 * @see Unsafe#compareAndSwapObject
+	 */
+	public static boolean compareAndSwapObject(Object base, int offset,
+	                                           Object expect, Object value) {
+		return atomicObject(atomic(MMP.OPS_AT_CAS, base, offset,
+		                           atomicRef(expect), atomicRef(value),
+		                           ATOMIC_REF)) == expect;
+	}
+
+	/**
+	 * @see Unsafe#getAndSetObject
+	 */
+	public static Object getAndSetObject(Object base, int offset,
+	                                     Object value) {
+		return atomicObject(atomic(MMP.OPS_AT_SWAP, base, offset,
+		                           atomicRef(value), 0, ATOMIC_REF));
+	}
+
+	/**
+	 * @see Unsafe#getObjectVolatile
+	 */
+	public static Object getObjectVolatile(Object base, int offset) {
+		return atomicObject(atomic(MMP.OPS_AT_GET, base, offset, 0, 0,
+		                           ATOMIC_REF));
+	}
+
+	/**
+	 * @see Unsafe#putObjectVolatile
+	 */
+	public static void putObjectVolatile(Object base, int offset,
+	                                     Object value) {
+		atomic(MMP.OPS_AT_SET, base, offset, atomicRef(value), 0, ATOMIC_REF);
 	}
 
 /*if[MICROBLAZE_BUILD]*/
@@ -33,6 +33,14 @@ import com.sun.squawk.util.*;
 
 public final class RWlock {
 
+    /**
+     * The managers reply with the lock's global address (see
+     * MMP.drainMailbox), so that is the event to wait for.
+     */
+    private int event() {
+        return Address.fromObject(this).toUWord().toPrimitive();
+    }
+
     private void writeLock0(boolean istry) throws NativePragma {
         throw Assert.shouldNotReachHere("unimplemented when hosted");
     }
@@ -40,7 +48,7 @@ public final class RWlock {
     public boolean tryWriteLock() {
         VMThread thread;
         writeLock0(true);
-        VMThread.waitForEvent(this.hashCode());
+        VMThread.waitForEvent(event());
         thread = VMThread.currentThread();
         // TODO: On success synchronize?
         return thread.getResult() != null;
@@ -48,7 +56,7 @@ public final class RWlock {
 
     public void writeLock() {
         writeLock0(false);
-        VMThread.waitForEvent(this.hashCode());
+        VMThread.waitForEvent(event());
         // TODO: On success synchronize?
         return;
     }
@@ -60,7 +68,7 @@ public final class RWlock {
     public boolean tryReadLock() {
         VMThread thread;
         readLock0(true);
-        VMThread.waitForEvent(this.hashCode());
+        VMThread.waitForEvent(event());
         thread = VMThread.currentThread();
         // TODO: On success synchronize?
         return thread.getResult() != null;
@@ -68,7 +76,7 @@ public final class RWlock {
 
     public void readLock() {
         readLock0(false);
-        VMThread.waitForEvent(this.hashCode());
+        VMThread.waitForEvent(event());
         // TODO: On success synchronize?
         return;
     }
@@ -34,7 +34,15 @@ import com.sun.squawk.pragma.*;
 
 public final class SoftwareCache {
 
-	static Object translate(Object oop) throws NativePragma {
+	/**
+	 * Returns our copy of an object, to access the byte at the given
+	 * offset of.  Large arrays are cached in chunks, so the copy is
+	 * only valid within the chunk holding that offset.
+	 *
+	 * @param oop    the object to translate
+	 * @param offset the offset (in bytes) from oop that is going to be accessed
+	 */
+	static Object translate(Object oop, int offset) throws NativePragma {
 		throw Assert.shouldNotReachHere("unimplemented when hosted");
 	}
 
@@ -46,4 +54,36 @@ public final class SoftwareCache {
 		throw Assert.shouldNotReachHere("unimplemented when hosted");
 	}
 
+	/**
+	 * Drops our copy of an object, if any, so that its next access
+	 * fetches it from its home.
+	 *
+	 * @param oop the object to drop
+	 */
+	public static void invalidate(Object oop) throws NativePragma {
+		throw Assert.shouldNotReachHere("unimplemented when hosted");
+	}
+
+	/**
+	 * Starts fetching an object to the software cache without waiting
+	 * for it to arrive.
+	 *
+	 * @param oop the object to prefetch
+	 */
+	public static void prefetch(Object oop) throws NativePragma {
+		throw Assert.shouldNotReachHere("unimplemented when hosted");
+	}
+
+	/**
+	 * Starts fetching the elements [from, to) of an array to the
+	 * software cache without waiting for them to arrive.
+	 *
+	 * @param array the array to prefetch
+	 * @param from  the index of the first element to prefetch
+	 * @param to    the index after the last element to prefetch
+	 */
+	public static void prefetchRange(Object array, int from, int to) throws NativePragma {
+		throw Assert.shouldNotReachHere("unimplemented when hosted");
+	}
+
 }
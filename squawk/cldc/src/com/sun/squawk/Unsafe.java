@@ -564,8 +564,170 @@ public final class Unsafe {
         NativeUnsafe.setUnalignedLong(base, boffset, value);
     }
 
-    public static boolean compareAndSwapInt(Object base, int expect, int value) {
-      return NativeUnsafe.compareAndSwapInt(base, expect, value);
+    /**
+     * Atomically sets a word of an object to the given value if it holds the expected value.
+     * The operation is executed at the object's home core.
+     *
+     * @param base   the object
+     * @param offset the offset (in words) from base to the word
+     * @param expect the expected value
+     * @param value  the new value
+     * @return true if the word held the expected value and was updated
+     */
+    public static boolean compareAndSwapInt(Object base, int offset, int expect, int value) {
+        return NativeUnsafe.compareAndSwapInt(base, offset, expect, value);
+    }
+
+    /**
+     * Atomically adds to a word of an object.
+     *
+     * @param base   the object
+     * @param offset the offset (in words) from base to the word
+     * @param delta  the value to add
+     * @return the previous value of the word
+     */
+    public static int getAndAddInt(Object base, int offset, int delta) {
+        return NativeUnsafe.getAndAddInt(base, offset, delta);
+    }
+
+    /**
+     * Atomically sets a word of an object to the given value.
+     *
+     * @param base   the object
+     * @param offset the offset (in words) from base to the word
+     * @param value  the new value
+     * @return the previous value of the word
+     */
+    public static int getAndSetInt(Object base, int offset, int value) {
+        return NativeUnsafe.getAndSetInt(base, offset, value);
+    }
+
+    /**
+     * Reads a word of an object from the object's home core, bypassing any cached copy.
+     *
+     * @param base   the object
+     * @param offset the offset (in words) from base to the word
+     * @return the value of the word
+     */
+    public static int getIntVolatile(Object base, int offset) {
+        return NativeUnsafe.getIntVolatile(base, offset);
+    }
+
+    /**
+     * Writes a word of an object at the object's home core, bypassing any cached copy.
+     *
+     * @param base   the object
+     * @param offset the offset (in words) from base to the word
+     * @param value  the new value
+     */
+    public static void putIntVolatile(Object base, int offset, int value) {
+        NativeUnsafe.putIntVolatile(base, offset, value);
+    }
+
+    /**
+     * Atomically sets a long field of an object to the given value if it holds the expected value.
+     *
+     * @param base   the object
+     * @param offset the offset (in words) from base to the field
+     * @param expect the expected value
+     * @param value  the new value
+     * @return true if the field held the expected value and was updated
+     */
+    public static boolean compareAndSwapLong(Object base, int offset, long expect, long value) {
+        return NativeUnsafe.compareAndSwapLong(base, offset, expect, value);
+    }
+
+    /**
+     * Atomically adds to a long field of an object.
+     *
+     * @param base   the object
+     * @param offset the offset (in words) from base to the field
+     * @param delta  the value to add
+     * @return the previous value of the field
+     */
+    public static long getAndAddLong(Object base, int offset, long delta) {
+        return NativeUnsafe.getAndAddLong(base, offset, delta);
+    }
+
+    /**
+     * Atomically sets a long field of an object to the given value.
+     *
+     * @param base   the object
+     * @param offset the offset (in words) from base to the field
+     * @param value  the new value
+     * @return the previous value of the field
+     */
+    public static long getAndSetLong(Object base, int offset, long value) {
+        return NativeUnsafe.getAndSetLong(base, offset, value);
+    }
+
+    /**
+     * Reads a long field of an object from the object's home core.
+     *
+     * @param base   the object
+     * @param offset the offset (in words) from base to the field
+     * @return the value of the field
+     */
+    public static long getLongVolatile(Object base, int offset) {
+        return NativeUnsafe.getLongVolatile(base, offset);
+    }
+
+    /**
+     * Writes a long field of an object at the object's home core.
+     *
+     * @param base   the object
+     * @param offset the offset (in words) from base to the field
+     * @param value  the new value
+     */
+    public static void putLongVolatile(Object base, int offset, long value) {
+        NativeUnsafe.putLongVolatile(base, offset, value);
+    }
+
+    /**
+     * Atomically sets a reference field of an object to the given value if it holds the expected value.
+     *
+     * @param base   the object
+     * @param offset the offset (in words) from base to the field
+     * @param expect the expected value
+     * @param value  the new value
+     * @return true if the field held the expected value and was updated
+     */
+    public static boolean compareAndSwapObject(Object base, int offset, Object expect, Object value) {
+        return NativeUnsafe.compareAndSwapObject(base, offset, expect, value);
+    }
+
+    /**
+     * Atomically sets a reference field of an object to the given value.
+     *
+     * @param base   the object
+     * @param offset the offset (in words) from base to the field
+     * @param value  the new value
+     * @return the previous value of the field
+     */
+    public static Object getAndSetObject(Object base, int offset, Object value) {
+        return NativeUnsafe.getAndSetObject(base, offset, value);
+    }
+
+    /**
+     * Reads a reference field of an object from the object's home core.
+     *
+     * @param base   the object
+     * @param offset the offset (in words) from base to the field
+     * @return the value of the field
+     */
+    public static Object getObjectVolatile(Object base, int offset) {
+        return NativeUnsafe.getObjectVolatile(base, offset);
+    }
+
+    /**
+     * Writes a reference field of an object at the object's home core.
+     *
+     * @param base   the object
+     * @param offset the offset (in words) from base to the field
+     * @param value  the new value
+     */
+    public static void putObjectVolatile(Object base, int offset, Object value) {
+        NativeUnsafe.putObjectVolatile(base, offset, value);
     }
 
 }
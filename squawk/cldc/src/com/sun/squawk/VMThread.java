@@ -127,6 +127,39 @@ public final class VMThread implements GlobalStaticFields {
 	 */
 	private static EventHashtable osevents;
 
+	/**
+	 * The events batch filled by MMP.drainMailbox().
+	 */
+	private static int[] mailbox;
+
+	/**
+	 * The threads spawned to this core and not yet started, as a ring
+	 * of their global addresses.  Idle cores may steal them, since
+	 * they have no state here yet (see rescheduleNext).
+	 */
+	private static int[] spawned;
+	private static int spawnedHead;
+	private static int spawnedCount;
+
+	/**
+	 * When (VM.getTimeMillis(), truncated) we last started a spawned
+	 * thread.  A busy core still starts one every SPAWNED_DELAY ms,
+	 * in case the running threads wait for them.
+	 */
+	private static int spawnedStarted;
+	private final static int SPAWNED_SIZE  = 64;
+	private final static int SPAWNED_DELAY = 2;
+
+	/**
+	 * Whether we wait for the reply to a steal request, and when we
+	 * may send the next one.  Refused requests back off exponentially
+	 * up to STEAL_BACKOFF_MAX ms.
+	 */
+	private static boolean stealing;
+	private static int stealAt;
+	private static int stealBackoff;
+	private final static int STEAL_BACKOFF_MAX = 64;
+
 	/**
 	 * Count of monitors allocated
 	 */
@@ -1032,10 +1065,21 @@ public final class VMThread implements GlobalStaticFields {
 	private int errno; /* save errno after native calls so java thread's will see correct errno value. */
 
 	/**
-	 * Holds the result from asynchronous functions (i.e., CAS)
+	 * Holds the result from asynchronous functions (i.e., RW locks)
 	 */
 	private Object result;
 
+	/**
+	 * Hold the previous value of the field of the last atomic primitive
+	 * (see NativeUnsafe.atomic), they are set by the VM.
+	 */
+	private int atomicValue;
+	private int atomicValueHigh;
+
+	long getAtomicValue() {
+		return ((long)atomicValueHigh << 32) | (atomicValue & 0xFFFFFFFFL);
+	}
+
 	public void setResult(Object res) {
 		result = res;
 	}
@@ -1367,6 +1411,8 @@ public final class VMThread implements GlobalStaticFields {
 		timerQueue          = new TimerQueue();
 		events              = new EventHashtable();
 		osevents            = new EventHashtable();
+		mailbox             = new int[MMP.BATCH_SIZE * MMP.BATCH_ENTRY];
+		spawned             = new int[SPAWNED_SIZE];
 		currentThread       = asVMThread(new Thread()); // Startup using a dummy thread
 		serviceThread       = currentThread;
 		max_wait            = -1; // encode value of Long.MAX_VALUE
@@ -1770,160 +1816,239 @@ public final class VMThread implements GlobalStaticFields {
 		VM.fatalVMError();
 	}
 
+	/**
+	 * Start a thread spawned to this core (see MMP.spawnThread).
+	 *
+	 * @param javathread the thread
+	 */
+	private static void startSpawned(Thread javathread) {
+		VMThread thread = new VMThread(javathread, javathread.getTName());
+		// VM.print("Incoming thread " + javathread.getTName() + "\n");
+		javathread.setVMThread(thread);
+		// HACK: Manually Write-back to avoid full synchronization
+		SoftwareCache.writeBack(javathread);
+		thread.localStart();
+		spawnedStarted = (int)VM.getTimeMillis();
+	}
+
+	/**
+	 * Take a thread spawned to this core.  Keep it unstarted while we
+	 * are busy, so that idle cores can steal it.
+	 *
+	 * @param key the global address of the thread
+	 */
+	private static void spawnedArrived(int key) {
+		if (runnableThreads.size() == 0 ||
+		    spawnedCount == SPAWNED_SIZE) {
+			startSpawned((Thread)Address.fromPrimitive(key).toObject());
+		} else {
+			spawned[(spawnedHead + spawnedCount) % SPAWNED_SIZE] = key;
+			spawnedCount++;
+		}
+	}
+
 	/**
 	 * Primitive method to choose the next executable thread.
 	 */
 	final static void rescheduleNext() {
 		Assert.that(GC.isSafeToSwitchThreads());
 		Object   object;
-		Integer  msg_op, hash;
 		VMThread thread;
-		Thread   javathread;
+		int      msg_op, key, n;
 
 		// if (VM.getCore() == 0 && VM.getIsland() == 0)
 		// 	VM.print("IN rescheduleNext\n");
-		/*
-		 * Although msg_op is used to return the msg type we
-		 * initialize it to get rid of warnings
-		 */
-		msg_op = MMP.OPS_NOP;
-		hash   = 0;
-
-		// if (VM.getCore() == 0 && VM.getIsland() == 0)
-		// 	VM.print("msg_op set\n");
 
 		/*
 		 * Loop until there is something to do.
 		 */
 		while (true) {
 
-			// if (VM.getCore() == 0 && VM.getIsland() == 0) {
-			// 	VM.print("msg_op (before)=");
-			// 	VM.print(msg_op);
-			// 	VM.print("\n");
-			// }
 			/*
-			 * Always Query the mailbox for new messages.
+			 * Always drain the mailbox.  The requests to this core
+			 * are served natively, we only get the events of our
+			 * threads.  Our load goes along, for the thread
+			 * placement of the other cores (see schdlrNext in scheduler.c).
 			 */
-			// if (VM.getCore() == 1 && VM.getIsland() == 0)
-			// 	VM.print("VMTHREAD check mbox " + System.currentTimeMillis() + " ms\n");
-			object = MMP.checkMailbox(msg_op, hash);
-			// if (VM.getCore() == 1 && VM.getIsland() == 0)
-			// 	VM.print("VMTHREAD checked mbox " + System.currentTimeMillis() + " ms\n");
-			// if (VM.getCore() == 0 && VM.getIsland() == 0) {
-			// 	VM.print("object=");
-			// 	if (object!=null)
-			// 		VM.print("notnull");
-			// 	else
-			// 		VM.print("null");
-			// 	VM.print("\n");
-			// 	VM.print("msg_op=");
-			// 	VM.print(msg_op);
-			// 	VM.print("\n");
-			// }
-			switch(msg_op) {
-			case MMP.OPS_TH_SPAWN: {
-				// There is a new thread for us
-				Assert.that(object != null);
-				javathread = (Thread)object;
-				// VM.print("VMTHREAD in java " + System.currentTimeMillis() + " ms\n");
-				thread = new VMThread(javathread, javathread.getTName());
-				// VM.print("Incoming thread " + javathread.getTName() + "\n");
-				// VM.print("VMTHREAD new thread " + System.currentTimeMillis() + " ms\n");
-				javathread.setVMThread(thread);
-				// VM.print("VMTHREAD set thread " + System.currentTimeMillis() + " ms\n");
-				// HACK: Manually Write-back to avoid full synchronization
-				SoftwareCache.writeBack(javathread);
-				// VM.print("VMTHREAD write-back " + System.currentTimeMillis() + " ms\n");
-				thread.localStart();
-				// VM.print("VMTHREAD started " + System.currentTimeMillis() + " ms\n");
-				// VM.print("Incoming Started\n");
-
-				break;
-			}
-			case MMP.OPS_MNTR_ACK: {
-				// We got a monitor.  Find a thread waiting for it and
-				// schedule it FIRST for execution.
-
-				// HACK: This way we give priority to waiting on
-				// monitors threads not respecting the actual thread
-				// priority, however we consider this to be fair since
-				// this thread already yielded at least once to wait
-				// for the monitor manager to reply.
-
-				Assert.that(object != null);
-				// VM.print("MMP.OPS_MNTR_ACK\n");
-				Monitor monitor = VM.getCurrentIsolate().getMonitor(hash);
-				// VM.print("got monitor\n");
-				Assert.that(monitor != null);
-				VMThread waiter = monitor.removeMonitorWait();
-				// VM.print("removed monitor\n");
-
-				Assert.that(waiter != null);
-				Assert.that(monitor.owner == null);
-				Assert.that(waiter.isAlive());
-
-				monitor.threshold = Monitor.MONITOR_THRESHOLD;
-				addFirstToRunnableThreadsQueue(waiter);
-				break;
-			}
-			case MMP.OPS_MNTR_NOTIFICATION: {
-				Monitor monitor = VM.getCurrentIsolate().getMonitor(hash);
-				Assert.that(monitor != null);
-				VMThread waiter = monitor.removeCondvarWait();
-				// VM.print("MMP.OPS_MNTR_NOTIFICATION\n");
-
-				if (waiter == null) {
-					/*
-					 * No waiters here, notify someone else
-					 *
-					 * FIXME: Send a special message instead so that
-					 * all waiters from this core get erased
-					 */
-					MMGR.notify(monitor.object, false);
+			n = MMP.drainMailbox(mailbox, runnableThreads.size());
+
+			for (int i = 0; i < n; i += MMP.BATCH_ENTRY) {
+				msg_op = mailbox[i + MMP.BATCH_OP];
+				key    = mailbox[i + MMP.BATCH_KEY];
+				object = Address.fromPrimitive(key).toObject();
+
+				switch (msg_op) {
+				case MMP.OPS_TH_SPAWN: {
+					// There is a new thread for us
+					Assert.that(object != null);
+					spawnedArrived(key);
+					break;
 				}
-				else {
-					addToRunnableThreadsQueue(waiter);
+				case MMP.OPS_TH_SPAWN_TREE: {
+					// There is a new thread for us in a spawn tree,
+					// the rest of our part is already handed on
+					Assert.that(object != null);
+					object = ((Thread[])object)[mailbox[i + MMP.BATCH_TENURE]];
+					spawnedArrived(Address.fromObject(object).toUWord().toPrimitive());
+					break;
 				}
-				break;
-			}
-			case MMP.OPS_MNTR_NOTIFICATION_ALL: {
-				Monitor monitor = VM.getCurrentIsolate().getMonitor(hash);
-				Assert.that(monitor != null);
-				VMThread waiter = monitor.removeCondvarWait();
-				// VM.print("MMP.OPS_MNTR_NOTIFICATION_ALL\n");
-
-				while (waiter != null) {
-					addToRunnableThreadsQueue(waiter);
-					waiter = monitor.removeCondvarWait();
+				case MMP.OPS_TH_STEAL: {
+					// An idle core asks for one of our unstarted
+					// threads, give it the latest
+					int thief = mailbox[i + MMP.BATCH_SUCCESSOR];
+
+					if (spawnedCount == 0) {
+						MMP.stealReply(thief, null);
+					} else {
+						spawnedCount--;
+						key = spawned[(spawnedHead + spawnedCount) % SPAWNED_SIZE];
+						MMP.stealReply(thief, (Thread)Address.fromPrimitive(key).toObject());
+					}
+					break;
+				}
+				case MMP.OPS_TH_STEAL_R: {
+					// We stole a thread, run it
+					Assert.that(object != null);
+					stealing = false;
+					stealBackoff = 0;
+					startSpawned((Thread)object);
+					break;
+				}
+				case MMP.OPS_TH_STEAL_NACK: {
+					stealing = false;
+					stealBackoff = (stealBackoff == 0) ? 1 :
+					               Math.min(stealBackoff * 2, STEAL_BACKOFF_MAX);
+					stealAt = (int)VM.getTimeMillis() + stealBackoff;
+					break;
+				}
+				case MMP.OPS_MNTR_ACK: {
+					// We got a monitor.  Find a thread waiting for it and
+					// schedule it FIRST for execution.
+
+					// HACK: This way we give priority to waiting on
+					// monitors threads not respecting the actual thread
+					// priority, however we consider this to be fair since
+					// this thread already yielded at least once to wait
+					// for the monitor manager to reply.
+
+					Assert.that(object != null);
+					// VM.print("MMP.OPS_MNTR_ACK\n");
+					Monitor monitor = VM.getCurrentIsolate().getMonitor(object);
+					// VM.print("got monitor\n");
+					Assert.that(monitor != null);
+					VMThread waiter = monitor.removeMonitorWait();
+					// VM.print("removed monitor\n");
+
+					Assert.that(waiter != null);
+					Assert.that(monitor.owner == null);
+					Assert.that(waiter.isAlive());
+
+					monitor.tenure = mailbox[i + MMP.BATCH_TENURE];
+					// A revoke for this tenure might have arrived first
+					monitor.revoked = monitor.revokedTenure == monitor.tenure;
+					monitor.threshold = monitor.revoked ? 0 : Monitor.MONITOR_THRESHOLD;
+					// Mark it as ours, so that a following revoke is not
+					// mistaken as stale
+					monitor.owner = waiter;
+					addFirstToRunnableThreadsQueue(waiter);
+					break;
+				}
+				case MMP.OPS_MNTR_REVOKE: {
+					// Another core wants a monitor we hold
+					Monitor monitor = VM.getCurrentIsolate().getMonitor(object);
+					Assert.that(monitor != null);
+					// VM.print("MMP.OPS_MNTR_REVOKE\n");
+					int tenure = mailbox[i + MMP.BATCH_TENURE];
+
+					if (tenure - monitor.tenure > 0) {
+						// On handoffs the revoke might overtake the grant
+						monitor.revokedTenure = tenure;
+						monitor.successor = mailbox[i + MMP.BATCH_SUCCESSOR];
+					}
+					else if (tenure != monitor.tenure) {
+						// Stale, from an older tenure
+					}
+					else if (monitor.leased && monitor.owner == null) {
+						// Nobody uses it, give it back right away
+						monitor.leased = false;
+						monitor.successor = mailbox[i + MMP.BATCH_SUCCESSOR];
+						giveBackMonitor(monitor);
+					}
+					else if (monitor.leased || monitor.owner != null) {
+						// Give it back on the next release
+						monitor.revoked = true;
+						monitor.successor = mailbox[i + MMP.BATCH_SUCCESSOR];
+						monitor.threshold = 0;
+					}
+					// Else we already released it and this is stale
+					break;
+				}
+				case MMP.OPS_MNTR_NOTIFICATION: {
+					Monitor monitor = VM.getCurrentIsolate().getMonitor(object);
+					Assert.that(monitor != null);
+					VMThread waiter = monitor.removeCondvarWait();
+					// VM.print("MMP.OPS_MNTR_NOTIFICATION\n");
+
+					if (waiter == null) {
+						/*
+						 * No waiters here, notify someone else
+						 *
+						 * FIXME: Send a special message instead so that
+						 * all waiters from this core get erased
+						 */
+						MMGR.notify(monitor.object, false);
+					}
+					else {
+						addToRunnableThreadsQueue(waiter);
+					}
+					break;
+				}
+				case MMP.OPS_MNTR_NOTIFICATION_ALL: {
+					Monitor monitor = VM.getCurrentIsolate().getMonitor(object);
+					Assert.that(monitor != null);
+					VMThread waiter = monitor.removeCondvarWait();
+					// VM.print("MMP.OPS_MNTR_NOTIFICATION_ALL\n");
+
+					while (waiter != null) {
+						addToRunnableThreadsQueue(waiter);
+						waiter = monitor.removeCondvarWait();
+					}
+					break;
+				}
+				case MMP.OPS_AT_CAS_ACK:
+				case MMP.OPS_AT_CAS_NACK:
+				case MMP.OPS_AT_FAD_R:
+				case MMP.OPS_AT_SWAP_R:
+				case MMP.OPS_AT_SET_R:
+				case MMP.OPS_AT_GET_R: {
+					// The result is already in the thread's atomicValue
+					thread = events.findEvent(key);
+					Assert.that(thread != null);
+					addToRunnableThreadsQueue(thread);
+					break;
+				}
+				case MMP.OPS_RW_WRITE_ACK:
+				case MMP.OPS_RW_READ_ACK: {
+					thread = events.findEvent(key);
+					Assert.that(thread != null);
+					thread.setResult(object);
+					// VM.print("MMP.OPS_*_ACK\n");
+					addToRunnableThreadsQueue(thread);
+					break;
+				}
+				case MMP.OPS_RW_WRITE_NACK:
+				case MMP.OPS_RW_READ_NACK: {
+					thread = events.findEvent(key);
+					Assert.that(thread != null);
+					thread.setResult(null);
+					// VM.print("MMP.OPS_*_NACK\n");
+					addToRunnableThreadsQueue(thread);
+					break;
+				}
+				default:
+					VM.print("WARNING: msg_op="+msg_op+" is not supported\n");
+					break;
 				}
-				break;
-			}
-			case MMP.OPS_AT_CAS_ACK:
-			case MMP.OPS_RW_WRITE_ACK:
-			case MMP.OPS_RW_READ_ACK: {
-				thread = events.findEvent(hash);
-				Assert.that(thread != null);
-				thread.setResult(object);
-				// VM.print("MMP.OPS_*_ACK\n");
-				addToRunnableThreadsQueue(thread);
-				break;
-			}
-			case MMP.OPS_AT_CAS_NACK:
-			case MMP.OPS_RW_WRITE_NACK:
-			case MMP.OPS_RW_READ_NACK: {
-				thread = events.findEvent(hash);
-				Assert.that(thread != null);
-				thread.setResult(null);
-				// VM.print("MMP.OPS_*_NACK\n");
-				addToRunnableThreadsQueue(thread);
-				break;
-			}
-			case MMP.OPS_NOP:
-				break;
-			default:
-				VM.print("WARNING: msg_op="+msg_op+" is not supported\n");
-				break;
 			}
 
 			// if (VM.getCore() == 0 && VM.getIsland() == 0)
@@ -1969,6 +2094,19 @@ public final class VMThread implements GlobalStaticFields {
 			}
 			// if (VM.getCore() == 0 && VM.getIsland() == 0)
 			// 	VM.print("After event\n");
+			/*
+			 * Start the oldest spawned thread if there is nothing
+			 * else to do, or if it waited long enough.
+			 */
+			if (spawnedCount > 0 &&
+			    (runnableThreads.size() == 0 ||
+			     (int)VM.getTimeMillis() - spawnedStarted > SPAWNED_DELAY)) {
+				key = spawned[spawnedHead];
+				spawnedHead = (spawnedHead + 1) % SPAWNED_SIZE;
+				spawnedCount--;
+				startSpawned((Thread)Address.fromPrimitive(key).toObject());
+			}
+
 			/*
 			 * Break if there is something to do.
 			 */
@@ -1977,6 +2115,14 @@ public final class VMThread implements GlobalStaticFields {
 				// VM.print("Found something to run\n");
 				break;
 			}
+
+			/*
+			 * We are idle, try to steal a thread from a busy core.
+			 */
+			if (!stealing && (int)VM.getTimeMillis() - stealAt >= 0) {
+				stealing = true;
+				MMP.steal();
+			}
 			// if (VM.getCore() == 0 && VM.getIsland() == 0)
 			// 	VM.print("Runnable\n");
 
@@ -2460,11 +2606,45 @@ public final class VMThread implements GlobalStaticFields {
 			}
 		}
 
-		MMGR.monitorExit(monitor.object);
+		/*
+		 * Keep a lease on the monitor, so that local threads can
+		 * re-acquire it without any messages, until another core
+		 * asks for it.
+		 */
+		if (!monitor.revoked && monitor.isMonitorWaitEmpty()) {
+			monitor.leased = true;
+			return false;
+		}
+
+		monitor.leased = false;
+		if (monitor.revoked) {
+			giveBackMonitor(monitor);
+		}
+		else {
+			MMGR.monitorExit(monitor.object);
+		}
 
 		return !monitor.isMonitorWaitEmpty();
 	}
 
+	/**
+	 * Give a revoked monitor back.  If the monitor manager told us who
+	 * is next, hand it to that core directly, saving the manager's
+	 * round trip from the transfer.
+	 *
+	 * @param monitor the monitor
+	 */
+	private static void giveBackMonitor(Monitor monitor) {
+		monitor.revoked = false;
+
+		if (monitor.successor != -1) {
+			MMGR.handoff(monitor.object, monitor.successor, monitor.tenure + 1);
+		}
+		else {
+			MMGR.monitorExit(monitor.object);
+		}
+	}
+
 	/**
 	 * Let go of the monitor and notify the MMGR that we are now
 	 * waiting on it, and allow a thread waiting for the lock to
@@ -2526,6 +2706,8 @@ public final class VMThread implements GlobalStaticFields {
 			}
 		}
 
+		monitor.leased = false;
+		monitor.revoked = false;
 		MMGR.waitMonitorExit(monitor.object);
 	}
 
@@ -2592,7 +2774,14 @@ public final class VMThread implements GlobalStaticFields {
 		Assert.that(monitor != null);
 
 		// If we own the lock we only need to increase its depth
-		if (monitor.owner == null) { // request the monitor
+		if (monitor.owner == null && monitor.leased) {
+			// Our core still holds the monitor, no need to ask the
+			// monitor manager
+			// traceMonitor("monitorEnter: Leased lock: ", monitor, object);
+			monitor.owner = currentThread;
+			monitor.depth = 1;
+		}
+		else if (monitor.owner == null) { // request the monitor
 			// traceMonitor("monitorEnter: Must wait for lock: ", monitor, object);
 			MMGR.monitorEnter(object);
 
@@ -34,6 +34,68 @@ import com.sun.squawk.pragma.*;
 
 public final class MMGR {
 
+	/**
+	 * Returns the number of monitor managers (see MMGR_PLACEMENT in
+	 * mmgr.h).
+	 *
+	 * @return the number of monitor managers
+	 */
+	public static int managerCount() throws NativePragma {
+		throw Assert.shouldNotReachHere("unimplemented when hosted");
+	}
+
+	/**
+	 * Returns the index of the monitor manager responsible for the
+	 * given object's monitor.  This is the same mapping the VM uses
+	 * to send the monitor requests.
+	 *
+	 * @param object The object
+	 * @return the manager's index (0 to managerCount()-1)
+	 */
+	public static int managerOf(Object object) throws NativePragma {
+		throw Assert.shouldNotReachHere("unimplemented when hosted");
+	}
+
+	/**
+	 * Find the slot of the given object in an open-addressing table
+	 * keyed by global addresses, as sent to the monitor managers (see
+	 * Isolate.getMonitor).
+	 *
+	 * @param keys   The table's keys, a power of two long with 0 in
+	 *               the empty slots
+	 * @param object The object
+	 * @return the slot holding the object's address or the empty slot
+	 *         to insert it in
+	 */
+	public static int monitorSlot(int[] keys, Object object) throws NativePragma {
+		throw Assert.shouldNotReachHere("unimplemented when hosted");
+	}
+
+	/**
+	 * Reset the statistics counters of all the monitor managers and
+	 * the mailbox send statistics of this core. Use with -DMMGR_STATS
+	 * and/or -DMMP_STATS
+	 */
+	public static void resetStats() {
+		for (int i = 0; i < managerCount(); ++i) {
+			MMP.mmgrResetStats(i);
+		}
+		MMP.resetStats();
+	}
+
+	/**
+	 * Print the statistics counters, including the served requests
+	 * (load), of all the monitor managers and the mailbox send
+	 * statistics of this core. Use with -DMMGR_STATS and/or
+	 * -DMMP_STATS
+	 */
+	public static void printStats() {
+		for (int i = 0; i < managerCount(); ++i) {
+			MMP.mmgrPrintStats(i);
+		}
+		MMP.printStats();
+	}
+
 	/**
 	 * Request to enter the given object's monitor.
 	 *
@@ -53,6 +115,18 @@ public final class MMGR {
 		throw Assert.shouldNotReachHere("unimplemented when hosted");
 	}
 
+	/**
+	 * Hand the given object's monitor directly to the next owner,
+	 * informing the monitor manager.
+	 *
+	 * @param object    The object to exit its monitor
+	 * @param successor The next owner (see MMP.BATCH_SUCCESSOR)
+	 * @param tenure    The next owner's tenure
+	 */
+	public static void handoff(Object object, int successor, int tenure) throws NativePragma {
+		throw Assert.shouldNotReachHere("unimplemented when hosted");
+	}
+
 	/**
 	 * Request to exit the given object's monitor and notify that we
 	 * will be waiting on it.
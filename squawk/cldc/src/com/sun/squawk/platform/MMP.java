@@ -40,7 +40,14 @@ public final class MMP {
 	public static final int OPS_MNTR_ACK              = 2;
 	public static final int OPS_MNTR_NOTIFICATION     = 3;
 	public static final int OPS_MNTR_NOTIFICATION_ALL = 4;
+	public static final int OPS_AT_CAS                = 17;
 	public static final int OPS_AT_CAS_ACK            = 18;
+	public static final int OPS_AT_SET                = 19;
+	public static final int OPS_AT_SET_R              = 20;
+	public static final int OPS_AT_GET                = 21;
+	public static final int OPS_AT_GET_R              = 22;
+	public static final int OPS_AT_FAD                = 23;
+	public static final int OPS_AT_SWAP               = 24;
 	public static final int OPS_AT_CAS_NACK           = 28;
 
 	public static final int OPS_RW_WRITE              = 30;
@@ -54,18 +61,49 @@ public final class MMP {
 	public static final int OPS_RW_READ_NACK          = 38;
 	public static final int OPS_RW_READ_UNLOCK        = 39;
 
+	public static final int OPS_MNTR_REVOKE           = 42;
+	public static final int OPS_MNTR_HANDOFF          = 43;
+	public static final int OPS_AT_FAD_R              = 44;
+	public static final int OPS_AT_SWAP_R             = 45;
+	public static final int OPS_TH_STEAL              = 47;
+	public static final int OPS_TH_STEAL_R            = 48;
+	public static final int OPS_TH_STEAL_NACK         = 49;
+	public static final int OPS_TH_SPAWN_TREE         = 50;
+
+	/* The layout of the drainMailbox() batch, must be the same as in mmp.h */
+	public static final int BATCH_OP        = 0;
+	public static final int BATCH_KEY       = 1;
+	public static final int BATCH_TENURE    = 2;
+	public static final int BATCH_SUCCESSOR = 3;
+	public static final int BATCH_ENTRY     = 4;
+	/* The events returned by each drainMailbox() call */
+	public static final int BATCH_SIZE      = 16;
+
 	/**
-	 * Query the mailbox for incoming messages and return a thread object
-	 * if one of the messages was about scheduling a thread to this core.
+	 * Drain the mailbox.  The requests to this core (e.g. as a
+	 * monitor or atomic primitives manager) are served natively and
+	 * only the events the scheduler has to handle are returned, in
+	 * entries of BATCH_ENTRY ints:
+	 *
+	 * BATCH_OP        the message type (OPS_*)
+	 * BATCH_KEY       the global address of the thread or object the
+	 *                 message is about, the key of its events
+	 * BATCH_TENURE    the tenure carried by monitor ACKs and revokes.
+	 *                 Tenures count the ownership changes of a monitor.
+	 *                 The index of the thread to start in the array
+	 *                 of spawn tree messages
+	 * BATCH_SUCCESSOR the next owner carried by monitor revokes,
+	 *                 packed as (board_ID << 3) | (core_ID), or -1
+	 *                 if there is none, or the thief of steal
+	 *                 requests
 	 *
-	 * @param  type The type of the received message (return)
+	 * @param  batch Where to store the events (return)
+	 * @param  load  This core's runnable threads, piggybacked on its
+	 *               requests for the other cores' thread placement
 	 *
-	 * @return a thread object if one of the messages was about scheduling
-	 *         a thread to this core,
-	 *         an object if one of the messages was a reply to a lock request
-	 *         NULL otherwise
+	 * @return the number of ints stored in the batch
 	 */
-	public static Object checkMailbox(Integer type, Integer hash) throws NativePragma {
+	public static int drainMailbox(int[] batch, int load) throws NativePragma {
 		throw Assert.shouldNotReachHere("unimplemented when hosted");
 	}
 
@@ -78,8 +116,58 @@ public final class MMP {
 		throw Assert.shouldNotReachHere("unimplemented when hosted");
 	}
 
+	/**
+	 * Spawn a thread on the given core or, if it is -1, near the home
+	 * of the given object (see Thread.setPreferredCore and
+	 * Thread.setNear).
+	 *
+	 * @param thread The thread to spawn
+	 * @param core   The core to run it packed as (board << 3) | core,
+	 *               or -1
+	 * @param near   The object to run it near, or null
+	 */
+	public static void spawnThreadNear(Thread thread, int core, Object near) throws NativePragma {
+		throw Assert.shouldNotReachHere("unimplemented when hosted");
+	}
+
+	/**
+	 * Spawn all the given threads through a spawn tree.  This core
+	 * writes back its data once and sends the halves of the array to
+	 * other cores, each of which starts the first thread of its part
+	 * and hands the halves of the rest on, the same way (see
+	 * OPS_TH_SPAWN_TREE).
+	 *
+	 * @param threads The threads to spawn, in an array no core has
+	 *                cached
+	 */
+	public static void spawnAll(Thread[] threads) throws NativePragma {
+		throw Assert.shouldNotReachHere("unimplemented when hosted");
+	}
+
+	/**
+	 * Ask a busy core for one of its not yet started threads.  It
+	 * replies with an OPS_TH_STEAL_R carrying the thread, or an
+	 * OPS_TH_STEAL_NACK.
+	 */
+	public static void steal() throws NativePragma {
+		throw Assert.shouldNotReachHere("unimplemented when hosted");
+	}
+
+	/**
+	 * Reply to an OPS_TH_STEAL request.
+	 *
+	 * @param thief  The thief (see BATCH_SUCCESSOR)
+	 * @param thread A thread that was spawned to this core and not
+	 *               started, or null to refuse
+	 */
+	public static void stealReply(int thief, Thread thread) throws NativePragma {
+		throw Assert.shouldNotReachHere("unimplemented when hosted");
+	}
+
 	/**
 	 * Reset the monitor manager statistics counters. Use with -DMMGR_STATS
+	 *
+	 * @param id The manager's index (see MMGR.managerCount())
 	 */
 	public static void mmgrResetStats(int id) throws NativePragma {
 		throw Assert.shouldNotReachHere("unimplemented when hosted");
@@ -87,9 +175,28 @@ public final class MMP {
 
 	/**
 	 * Print the monitor manager statistics counters. Use with -DMMGR_STATS
+	 *
+	 * @param id The manager's index (see MMGR.managerCount())
 	 */
 	public static void mmgrPrintStats(int id) throws NativePragma {
 		throw Assert.shouldNotReachHere("unimplemented when hosted");
 	}
 
+	/**
+	 * Reset this core's mailbox send statistics counters. Use with
+	 * -DMMP_STATS
+	 */
+	public static void resetStats() throws NativePragma {
+		throw Assert.shouldNotReachHere("unimplemented when hosted");
+	}
+
+	/**
+	 * Print this core's mailbox send statistics counters, the
+	 * blocking sends, posts, Nacks and fences along with the cycles
+	 * they took. Use with -DMMP_STATS
+	 */
+	public static void printStats() throws NativePragma {
+		throw Assert.shouldNotReachHere("unimplemented when hosted");
+	}
+
 }
@@ -165,17 +165,17 @@ public final class Native {
         /*  56 */"F" +                       "zero " +
         "";
 
-    public final static int com_sun_squawk_NativeUnsafe$call0             = 57;
-    public final static int com_sun_squawk_NativeUnsafe$call1             = 58;
-    public final static int com_sun_squawk_NativeUnsafe$call10            = 59;
-    public final static int com_sun_squawk_NativeUnsafe$call2             = 60;
-    public final static int com_sun_squawk_NativeUnsafe$call3             = 61;
-    public final static int com_sun_squawk_NativeUnsafe$call4             = 62;
-    public final static int com_sun_squawk_NativeUnsafe$call5             = 63;
-    public final static int com_sun_squawk_NativeUnsafe$call6             = 64;
-    public final static int com_sun_squawk_NativeUnsafe$cancelTaskExecutor = 65;
-    public final static int com_sun_squawk_NativeUnsafe$charAt            = 66;
-    public final static int com_sun_squawk_NativeUnsafe$compareAndSwapInt0 = 67;
+    public final static int com_sun_squawk_NativeUnsafe$atomic0           = 57;
+    public final static int com_sun_squawk_NativeUnsafe$call0             = 58;
+    public final static int com_sun_squawk_NativeUnsafe$call1             = 59;
+    public final static int com_sun_squawk_NativeUnsafe$call10            = 60;
+    public final static int com_sun_squawk_NativeUnsafe$call2             = 61;
+    public final static int com_sun_squawk_NativeUnsafe$call3             = 62;
+    public final static int com_sun_squawk_NativeUnsafe$call4             = 63;
+    public final static int com_sun_squawk_NativeUnsafe$call5             = 64;
+    public final static int com_sun_squawk_NativeUnsafe$call6             = 65;
+    public final static int com_sun_squawk_NativeUnsafe$cancelTaskExecutor = 66;
+    public final static int com_sun_squawk_NativeUnsafe$charAt            = 67;
     public final static int com_sun_squawk_NativeUnsafe$copyTypes         = 68;
     public final static int com_sun_squawk_NativeUnsafe$deleteNativeTask  = 69;
     public final static int com_sun_squawk_NativeUnsafe$deleteTaskExecutor = 70;
@@ -276,21 +276,34 @@ public final class Native {
     public final static int com_sun_squawk_Lisp2Bitmap$testAndSetBitFor   = 165;
     public final static int com_sun_squawk_Lisp2Bitmap$testBitFor         = 166;
     public final static int com_sun_squawk_SoftwareCache$inHeap           = 167;
-    public final static int com_sun_squawk_SoftwareCache$translate        = 168;
-    public final static int com_sun_squawk_SoftwareCache$writeBack        = 169;
-    public final static int com_sun_squawk_platform_MMP$checkMailbox      = 170;
-    public final static int com_sun_squawk_platform_MMP$mmgrPrintStats    = 171;
-    public final static int com_sun_squawk_platform_MMP$mmgrResetStats    = 172;
-    public final static int com_sun_squawk_platform_MMP$spawnThread       = 173;
-    public final static int com_sun_squawk_platform_MMGR$addWaiter        = 174;
-    public final static int com_sun_squawk_platform_MMGR$monitorEnter     = 175;
-    public final static int com_sun_squawk_platform_MMGR$monitorExit      = 176;
-    public final static int com_sun_squawk_platform_MMGR$notify           = 177;
-    public final static int com_sun_squawk_platform_MMGR$removeWaiter     = 178;
-    public final static int com_sun_squawk_platform_MMGR$waitMonitorExit  = 179;
-    public final static int com_sun_squawk_RWlock$readLock0               = 180;
-    public final static int com_sun_squawk_RWlock$unlock0                 = 181;
-    public final static int com_sun_squawk_RWlock$writeLock0              = 182;
-    public final static int com_sun_squawk_VM$lcmp                        = 183;
-    public final static int ENTRY_COUNT                                   = 184;
+    public final static int com_sun_squawk_SoftwareCache$invalidate       = 168;
+    public final static int com_sun_squawk_SoftwareCache$prefetch         = 169;
+    public final static int com_sun_squawk_SoftwareCache$prefetchRange    = 170;
+    public final static int com_sun_squawk_SoftwareCache$translate        = 171;
+    public final static int com_sun_squawk_SoftwareCache$writeBack        = 172;
+    public final static int com_sun_squawk_platform_MMP$drainMailbox      = 173;
+    public final static int com_sun_squawk_platform_MMP$mmgrPrintStats    = 174;
+    public final static int com_sun_squawk_platform_MMP$mmgrResetStats    = 175;
+    public final static int com_sun_squawk_platform_MMP$printStats        = 176;
+    public final static int com_sun_squawk_platform_MMP$resetStats        = 177;
+    public final static int com_sun_squawk_platform_MMP$spawnAll          = 178;
+    public final static int com_sun_squawk_platform_MMP$spawnThread       = 179;
+    public final static int com_sun_squawk_platform_MMP$spawnThreadNear   = 180;
+    public final static int com_sun_squawk_platform_MMP$steal             = 181;
+    public final static int com_sun_squawk_platform_MMP$stealReply        = 182;
+    public final static int com_sun_squawk_platform_MMGR$addWaiter        = 183;
+    public final static int com_sun_squawk_platform_MMGR$handoff          = 184;
+    public final static int com_sun_squawk_platform_MMGR$managerCount     = 185;
+    public final static int com_sun_squawk_platform_MMGR$managerOf        = 186;
+    public final static int com_sun_squawk_platform_MMGR$monitorEnter     = 187;
+    public final static int com_sun_squawk_platform_MMGR$monitorExit      = 188;
+    public final static int com_sun_squawk_platform_MMGR$monitorSlot      = 189;
+    public final static int com_sun_squawk_platform_MMGR$notify           = 190;
+    public final static int com_sun_squawk_platform_MMGR$removeWaiter     = 191;
+    public final static int com_sun_squawk_platform_MMGR$waitMonitorExit  = 192;
+    public final static int com_sun_squawk_RWlock$readLock0               = 193;
+    public final static int com_sun_squawk_RWlock$unlock0                 = 194;
+    public final static int com_sun_squawk_RWlock$writeLock0              = 195;
+    public final static int com_sun_squawk_VM$lcmp                        = 196;
+    public final static int ENTRY_COUNT                                   = 197;
 }
@@ -117,6 +117,23 @@ public class Thread implements Runnable {
      */
     private boolean spawned;
 
+    /**
+     * Whether this thread was started (see start and startAll), set
+     * by the starting core before the thread gets spawned
+     */
+    private boolean started;
+
+    /**
+     * The core to spawn this thread on, packed as (board << 3) | core,
+     * or -1 to let the scheduler pick one
+     */
+    private int preferredCore = -1;
+
+    /**
+     * The object whose home core to spawn this thread on, if any
+     */
+    private Object near;
+
 
     /**
      * The argument supplied to the current call to
@@ -359,8 +376,88 @@ public class Thread implements Runnable {
      * @see        java.lang.Thread#run()
      */
     public void start() {
+        if (started)
+            throw new IllegalThreadStateException();
+        started = true;
+
         // FIXME: Mark all object references in the stack
-        MMP.spawnThread(this);
+        Object home = near;
+/*if[SPAWN_NEAR_TARGET]*/
+        if (home == null)
+            home = target;
+/*end[SPAWN_NEAR_TARGET]*/
+
+        if (preferredCore >= 0 || home != null)
+            MMP.spawnThreadNear(this, preferredCore, home);
+        else
+            MMP.spawnThread(this);
+    }
+
+    /**
+     * Starts all the given threads, as if calling <code>start</code>
+     * on each of them.  Much faster than that for many threads, since
+     * the calling thread writes back its data once and the threads are
+     * handed out to the cores through a spawn tree.  Placement hints
+     * (see <code>setNear</code>) are not honored.
+     *
+     * @param threads the threads to start
+     * @exception  NullPointerException  if an entry is null.
+     * @exception  IllegalThreadStateException  if a thread was
+     *               already started, or is given twice.  None of the
+     *               threads is started then.
+     * @see   #start()
+     */
+    public static void startAll(Thread[] threads) {
+        // Spawn a fresh copy of the array, which no core has cached
+        Thread[] copy = new Thread[threads.length];
+
+        // Mark them started here, the spawning cores cannot report
+        // bad entries back to us
+        for (int i = 0; i < threads.length; i++) {
+            Thread t = threads[i];
+
+            if (t == null || t.started) {
+                while (--i >= 0)
+                    copy[i].started = false;
+
+                if (t == null)
+                    throw new NullPointerException();
+                throw new IllegalThreadStateException();
+            }
+
+            t.started = true;
+            copy[i]   = t;
+        }
+
+        MMP.spawnAll(copy);
+    }
+
+    /**
+     * Asks for this thread to be spawned on the given core.  The
+     * scheduler never spawns a thread on the core that starts it, so
+     * if that is the given core another core of its board is used.
+     * Has no effect once the thread is started.
+     *
+     * @param core the core packed as (board << 3) | core, or -1 to
+     *             let the scheduler pick one
+     * @see   #setNear(Object)
+     */
+    public final void setPreferredCore(int core) {
+        preferredCore = core;
+    }
+
+    /**
+     * Asks for this thread to be spawned on the home core of the given
+     * object (or on its board, see SCHDLR_NEAR_BOARD), where the object
+     * lives in memory, so that the thread finds it close.  A core given
+     * with <code>setPreferredCore</code> takes precedence.  Has no
+     * effect once the thread is started.
+     *
+     * @param obj the object, or null to let the scheduler pick a core
+     * @see   #setPreferredCore(int)
+     */
+    public final void setNear(Object obj) {
+        near = obj;
     }
 
     /**
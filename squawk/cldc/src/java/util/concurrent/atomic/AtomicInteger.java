@@ -55,8 +55,10 @@ import com.sun.squawk.*;
  * @author Foivos S. Zakkak
 */
 public class AtomicInteger extends Number {
-    private int value;
-    private RWlock lock;
+    /* The word offset of value, it is the only field */
+    private static final int VALUE = 0;
+
+    private volatile int value;
 
     /**
      * Creates a new AtomicInteger with the given initial value.
@@ -64,16 +66,15 @@ public class AtomicInteger extends Number {
      * @param initialValue the initial value
      */
     public AtomicInteger(int initialValue) {
-        lock = new RWlock();
+        // The new object is homed at this core, no need to go through
+        // the atomic primitives
         value = initialValue;
-        // TODO write-back after constructor
     }
 
     /**
      * Creates a new AtomicInteger with initial value {@code 0}.
      */
     public AtomicInteger() {
-        lock = new RWlock();
     }
 
     /**
@@ -82,11 +83,7 @@ public class AtomicInteger extends Number {
      * @return the current value
      */
     public final int get() {
-        int ret;
-        lock.readLock();
-        ret = value;
-        lock.readUnlock();
-        return ret;
+        return Unsafe.getIntVolatile(this, VALUE);
     }
 
     /**
@@ -95,20 +92,18 @@ public class AtomicInteger extends Number {
      * @param newValue the new value
      */
     public final void set(int newValue) {
-        lock.writeLock();
-        value = newValue;
-        lock.writeUnlock();
+        Unsafe.putIntVolatile(this, VALUE, newValue);
     }
 
-    // /**
-    //  * Eventually sets to the given value.
-    //  *
-    //  * @param newValue the new value
-    //  * @since 1.6
-    //  */
-    // public final void lazySet(int newValue) {
-    //     Unsafe.putOrderedInt(this, valueOffset, newValue);
-    // }
+    /**
+     * Eventually sets to the given value.
+     *
+     * @param newValue the new value
+     * @since 1.6
+     */
+    public final void lazySet(int newValue) {
+        Unsafe.putIntVolatile(this, VALUE, newValue);
+    }
 
     /**
      * Atomically sets to the given value and returns the old value.
@@ -117,14 +112,7 @@ public class AtomicInteger extends Number {
      * @return the previous value
      */
     public final int getAndSet(int newValue) {
-        int current;
-
-        lock.writeLock();
-        current = value;
-        value   = newValue;
-        lock.writeUnlock();
-
-        return current;
+        return Unsafe.getAndSetInt(this, VALUE, newValue);
     }
 
     /**
@@ -137,17 +125,7 @@ public class AtomicInteger extends Number {
      * the actual value was not equal to the expected value.
      */
     public final boolean compareAndSet(int expect, int update) {
-        lock.writeLock();
-        // TODO: Optimize by getting a read lock first and only
-        // update to write if needed
-        if (value != expect) {
-            lock.writeUnlock();
-            return false;
-        }
-
-        value = update;
-        lock.writeUnlock();
-        return true;
+        return Unsafe.compareAndSwapInt(this, VALUE, expect, update);
     }
 
     /**
@@ -163,19 +141,7 @@ public class AtomicInteger extends Number {
      * @return true if successful.
      */
     public final boolean weakCompareAndSet(int expect, int update) {
-        if (lock.tryWriteLock()) {
-            // TODO: Optimize by getting a read lock first and only
-            // update to write if needed
-            if (value != expect) {
-                lock.writeUnlock();
-                return false;
-            }
-
-            value = update;
-            lock.writeUnlock();
-            return true;
-        }
-        return false;
+        return Unsafe.compareAndSwapInt(this, VALUE, expect, update);
     }
 
     /**
@@ -203,17 +169,7 @@ public class AtomicInteger extends Number {
      * @return the previous value
      */
     public final int getAndAdd(int delta) {
-        int current;
-
-        lock.writeLock();
-        current = value;
-        value   = current + delta;
-        // System.out.print("Current = " + current +
-        //                  " Delta = " + delta +
-        //                  " Value = " + value + "\n");
-        lock.writeUnlock();
-
-        return current;
+        return Unsafe.getAndAddInt(this, VALUE, delta);
     }
 
     /**
@@ -241,14 +197,7 @@ public class AtomicInteger extends Number {
      * @return the updated value
      */
     public final int addAndGet(int delta) {
-        int next;
-
-        lock.writeLock();
-        next  = value + delta;
-        value = next;
-        lock.writeUnlock();
-
-        return next;
+        return Unsafe.getAndAddInt(this, VALUE, delta) + delta;
     }
 
     /**
@@ -52,18 +52,10 @@ public class AtomicReference<V>  // implements java.io.Serializable
 {
     // private static final long serialVersionUID = -1848883965231344442L;
 
-    // private static final Unsafe unsafe = Unsafe.getUnsafe();
-    // private static final long valueOffset;
-
-    // static {
-    //   try {
-    //     valueOffset = unsafe.objectFieldOffset
-    //         (AtomicReference.class.getDeclaredField("value"));
-    //   } catch (Exception ex) { throw new Error(ex); }
-    // }
+    /* The word offset of value, it is the only field */
+    private static final int VALUE = 0;
 
     private volatile V value;
-    private RWlock lock;
 
     /**
      * Creates a new AtomicReference with the given initial value.
@@ -71,16 +63,15 @@ public class AtomicReference<V>  // implements java.io.Serializable
      * @param initialValue the initial value
      */
     public AtomicReference(V initialValue) {
-        lock = new RWlock();
+        // The new object is homed at this core, no need to go through
+        // the atomic primitives
         value = initialValue;
-        // TODO write-back after constructor
     }
 
     /**
      * Creates a new AtomicReference with null initial value.
      */
     public AtomicReference() {
-        lock = new RWlock();
     }
 
     /**
@@ -89,11 +80,7 @@ public class AtomicReference<V>  // implements java.io.Serializable
      * @return the current value
      */
     public final V get() {
-        V ret;
-        lock.readLock();
-        ret = value;
-        lock.readUnlock();
-        return ret;
+        return (V)Unsafe.getObjectVolatile(this, VALUE);
     }
 
     /**
@@ -102,20 +89,18 @@ public class AtomicReference<V>  // implements java.io.Serializable
      * @param newValue the new value
      */
     public final void set(V newValue) {
-        lock.writeLock();
-        value = newValue;
-        lock.writeUnlock();
+        Unsafe.putObjectVolatile(this, VALUE, newValue);
     }
 
-    // /**
-    //  * Eventually sets to the given value.
-    //  *
-    //  * @param newValue the new value
-    //  * @since 1.6
-    //  */
-    // public final void lazySet(V newValue) {
-    //     unsafe.putOrderedObject(this, valueOffset, newValue);
-    // }
+    /**
+     * Eventually sets to the given value.
+     *
+     * @param newValue the new value
+     * @since 1.6
+     */
+    public final void lazySet(V newValue) {
+        Unsafe.putObjectVolatile(this, VALUE, newValue);
+    }
 
     /**
      * Atomically sets the value to the given updated value
@@ -126,17 +111,7 @@ public class AtomicReference<V>  // implements java.io.Serializable
      * the actual value was not equal to the expected value.
      */
     public final boolean compareAndSet(V expect, V update) {
-        lock.writeLock();
-        // TODO: Optimize by getting a read lock first and only
-        // update to write if needed
-        if (value != expect) {
-            lock.writeUnlock();
-            return false;
-        }
-
-        value = update;
-        lock.writeUnlock();
-        return true;
+        return Unsafe.compareAndSwapObject(this, VALUE, expect, update);
     }
 
     /**
@@ -152,19 +127,7 @@ public class AtomicReference<V>  // implements java.io.Serializable
      * @return true if successful.
      */
     public final boolean weakCompareAndSet(V expect, V update) {
-        if (lock.tryWriteLock()) {
-            // TODO: Optimize by getting a read lock first and only
-            // update to write if needed
-            if (value != expect) {
-                lock.writeUnlock();
-                return false;
-            }
-
-            value = update;
-            lock.writeUnlock();
-            return true;
-        }
-        return false;
+        return Unsafe.compareAndSwapObject(this, VALUE, expect, update);
     }
 
     /**
@@ -174,11 +137,7 @@ public class AtomicReference<V>  // implements java.io.Serializable
      * @return the previous value
      */
     public final V getAndSet(V newValue) {
-        while (true) {
-            V x = get();
-            if (compareAndSet(x, newValue))
-                return x;
-        }
+        return (V)Unsafe.getAndSetObject(this, VALUE, newValue);
     }
 
     /**
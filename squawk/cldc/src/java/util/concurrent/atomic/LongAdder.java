@@ -0,0 +1,241 @@
+/*
+ * Copyright 2013-15, FORTH-ICS / CARV
+ *                    (Foundation for Research & Technology -- Hellas,
+ *                     Institute of Computer Science,
+ *                     Computer Architecture & VLSI Systems Laboratory)
+ * DO NOT ALTER OR REMOVE COPYRIGHT NOTICES OR THIS FILE HEADER.
+ *
+ * This code is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 only, as
+ * published by the Free Software Foundation.  Oracle designates this
+ * particular file as subject to the "Classpath" exception as provided
+ * by Oracle in the LICENSE file that accompanied this code.
+ *
+ * This code is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License
+ * version 2 for more details (a copy is included in the LICENSE file that
+ * accompanied this code).
+ *
+ * You should have received a copy of the GNU General Public License version
+ * 2 along with this work; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Please contact Oracle, 500 Oracle Parkway, Redwood Shores, CA 94065 USA
+ * or visit www.oracle.com if you need additional information or have any
+ * questions.
+ */
+
+/*
+ * This file is available under and governed by the GNU General Public
+ * License version 2 only, as published by the Free Software Foundation.
+ * However, the following notice accompanied the original version of this
+ * file:
+ *
+ * Written by Doug Lea with assistance from members of JCP JSR-166
+ * Expert Group and released to the public domain, as explained at
+ * http://creativecommons.org/licenses/publicdomain
+ */
+
+package java.util.concurrent.atomic;
+import com.sun.squawk.*;
+
+/**
+ * One or more variables that together maintain an initially zero
+ * {@code long} sum.  When updates are contended across cores the set
+ * of variables spreads out, so that every core updates its own cell,
+ * which is allocated in its heap slice and updated without any
+ * messages.  Method {@link #sum} returns the current total combined
+ * across the cells.
+ *
+ * <p>This class is usually preferable to {@link AtomicLong} when
+ * multiple threads update a common sum that is used for purposes such
+ * as collecting statistics, not for fine-grained synchronization
+ * control.  Under low update contention, the two classes have similar
+ * characteristics.  But under high contention, expected throughput of
+ * this class is significantly higher, at the expense of more
+ * expensive reads.
+ *
+ * @since 1.8
+ * @author Doug Lea
+ * @author Foivos S. Zakkak
+ */
+public class LongAdder extends Number {
+
+    /**
+     * A core's cell, always allocated in the heap slice of the core
+     * that updates it.
+     */
+    static final class Cell {
+        volatile long value;
+    }
+
+    /* The word offset of Cell.value, it is the only field */
+    private static final int VALUE = 0;
+
+    /* The number of cells, one per core (64 boards with 8 cores each) */
+    private static final int CELLS = 64 << 3;
+
+    /*
+     * The cells indexed by (board << 3) | core.  Entries are only set
+     * once, so reading them through the software cache is safe as
+     * long as we check the home copy before installing a new cell.
+     */
+    private final Cell[] cells;
+
+    /**
+     * Creates a new adder with initial sum of zero.
+     */
+    public LongAdder() {
+        cells = new Cell[CELLS];
+    }
+
+    /**
+     * Returns the cell of the current core, creating it if needed.
+     */
+    private Cell cell() {
+        int  me = (VM.getIsland() << 3) | VM.getCore();
+        Cell c  = cells[me];
+
+        if (c == null) {
+            // Our copy of cells might be stale, check the home copy
+            c = (Cell)Unsafe.getObjectVolatile(cells, me);
+
+            if (c == null) {
+                Cell n = new Cell();
+
+                if (Unsafe.compareAndSwapObject(cells, me, null, n))
+                    return n;
+
+                c = (Cell)Unsafe.getObjectVolatile(cells, me);
+            }
+        }
+
+        return c;
+    }
+
+    /**
+     * Adds the given value.
+     *
+     * @param x the value to add
+     */
+    public void add(long x) {
+        // The cell is homed at this core, this takes no messages
+        Unsafe.getAndAddLong(cell(), VALUE, x);
+    }
+
+    /**
+     * Equivalent to {@code add(1)}.
+     */
+    public void increment() {
+        add(1L);
+    }
+
+    /**
+     * Equivalent to {@code add(-1)}.
+     */
+    public void decrement() {
+        add(-1L);
+    }
+
+    /**
+     * Returns the current sum.  The returned value is <em>NOT</em> an
+     * atomic snapshot; invocation in the absence of concurrent
+     * updates returns an accurate result, but concurrent updates that
+     * occur while the sum is being calculated might not be
+     * incorporated.
+     *
+     * <p>Every cell is read at its home core, where it is updated.
+     *
+     * @return the sum
+     */
+    public long sum() {
+        Cell[] as  = cells;
+        long   sum = 0L;
+        Cell   c;
+
+        // Get the cells created since we last cached the array
+        SoftwareCache.invalidate(as);
+
+        for (int i = 0; i < CELLS; ++i) {
+            if ((c = as[i]) != null)
+                sum += Unsafe.getLongVolatile(c, VALUE);
+        }
+
+        return sum;
+    }
+
+    /**
+     * Resets variables maintaining the sum to zero.  This method may
+     * be a useful alternative to creating a new adder, but is only
+     * effective if there are no concurrent updates.  Because this
+     * method is intrinsically racy, it should only be used when it is
+     * known that no threads are concurrently updating.
+     */
+    public void reset() {
+        Cell[] as = cells;
+        Cell   c;
+
+        SoftwareCache.invalidate(as);
+
+        for (int i = 0; i < CELLS; ++i) {
+            if ((c = as[i]) != null)
+                Unsafe.putLongVolatile(c, VALUE, 0L);
+        }
+    }
+
+    /**
+     * Equivalent in effect to {@link #sum} followed by {@link
+     * #reset}. This method may apply for example during quiescent
+     * points between multithreaded computations.  If there are
+     * updates concurrent with this method, the returned value is
+     * <em>not</em> guaranteed to be the final value occurring before
+     * the reset.
+     *
+     * @return the sum
+     */
+    public long sumThenReset() {
+        Cell[] as  = cells;
+        long   sum = 0L;
+        Cell   c;
+
+        SoftwareCache.invalidate(as);
+
+        for (int i = 0; i < CELLS; ++i) {
+            if ((c = as[i]) != null)
+                sum += Unsafe.getAndSetLong(c, VALUE, 0L);
+        }
+
+        return sum;
+    }
+
+    /**
+     * Returns the String representation of the {@link #sum}.
+     * @return the String representation of the {@link #sum}
+     */
+    public String toString() {
+        return Long.toString(sum());
+    }
+
+    /**
+     * Equivalent to {@link #sum}.
+     *
+     * @return the sum
+     */
+    public long longValue() {
+        return sum();
+    }
+
+    public int intValue() {
+        return (int)sum();
+    }
+
+    public float floatValue() {
+        return (float)sum();
+    }
+
+    public double doubleValue() {
+        return (double)sum();
+    }
+
+}
@@ -137,6 +137,7 @@ CFLAGS =\
 	-DMMGR_QUEUE \
 	-DWAITER_REUSE \
 	-DNDEBUG \
+#	-DMMGR_STATS \
 #	-DASSUME \
 #	-DVERY_VERBOSE \
 
@@ -220,6 +221,7 @@ FORMIC_OBJS =\
 	apmgr.mb.o \
 	mmp.mb.o \
 	os.mb.o \
+	topology.mb.o \
 
 FORMIC_OBJS:=$(addprefix $(BUILD_DIR)/obj/$(RTS_SRC)/,$(FORMIC_OBJS))
 ################################################################################
@@ -479,6 +479,18 @@ class NativeVerifierHelper {
             return;
         }
 
+        case Native.com_sun_squawk_NativeUnsafe$atomic0: {
+            frame.pop(INT); // int
+            frame.pop(LONG); // long
+            frame.pop(LONG); // long
+            frame.pop(INT); // int
+            frame.pop(OOP); // java.lang.Object
+            frame.pop(INT); // int
+            Assert.that(frame.isStackEmpty());
+            frame.push(BOOLEAN); // boolean
+            return;
+        }
+
         case Native.com_sun_squawk_NativeUnsafe$call0: {
             frame.pop(REF); // com.sun.squawk.Address
             Assert.that(frame.isStackEmpty());
@@ -581,14 +593,6 @@ class NativeVerifierHelper {
             return;
         }
 
-        case Native.com_sun_squawk_NativeUnsafe$compareAndSwapInt0: {
-            frame.pop(INT); // int
-            frame.pop(INT); // int
-            frame.pop(OOP); // java.lang.Object
-            Assert.that(frame.isStackEmpty());
-            frame.push(BOOLEAN); // boolean
-            return;
-        }
 
         case Native.com_sun_squawk_NativeUnsafe$copyTypes: {
             frame.pop(INT); // int
@@ -1327,7 +1331,28 @@ class NativeVerifierHelper {
             return;
         }
 
+        case Native.com_sun_squawk_SoftwareCache$invalidate: {
+            frame.pop(OOP); // java.lang.Object
+            Assert.that(frame.isStackEmpty());
+            return;
+        }
+
+        case Native.com_sun_squawk_SoftwareCache$prefetch: {
+            frame.pop(OOP); // java.lang.Object
+            Assert.that(frame.isStackEmpty());
+            return;
+        }
+
+        case Native.com_sun_squawk_SoftwareCache$prefetchRange: {
+            frame.pop(INT); // int
+            frame.pop(INT); // int
+            frame.pop(OOP); // java.lang.Object
+            Assert.that(frame.isStackEmpty());
+            return;
+        }
+
         case Native.com_sun_squawk_SoftwareCache$translate: {
+            frame.pop(INT); // int
             frame.pop(OOP); // java.lang.Object
             Assert.that(frame.isStackEmpty());
             frame.push(OOP); // java.lang.Object
@@ -1340,11 +1365,11 @@ class NativeVerifierHelper {
             return;
         }
 
-        case Native.com_sun_squawk_platform_MMP$checkMailbox: {
-            frame.pop(OOP); // java.lang.Integer
-            frame.pop(OOP); // java.lang.Integer
+        case Native.com_sun_squawk_platform_MMP$drainMailbox: {
+            frame.pop(INT); // int
+            frame.pop(OOP); // int[]
             Assert.that(frame.isStackEmpty());
-            frame.push(OOP); // java.lang.Object
+            frame.push(INT); // int
             return;
         }
 
@@ -1360,24 +1385,89 @@ class NativeVerifierHelper {
             return;
         }
 
+        case Native.com_sun_squawk_platform_MMP$printStats: {
+            Assert.that(frame.isStackEmpty());
+            return;
+        }
+
+        case Native.com_sun_squawk_platform_MMP$resetStats: {
+            Assert.that(frame.isStackEmpty());
+            return;
+        }
+
+        case Native.com_sun_squawk_platform_MMP$spawnAll: {
+            frame.pop(OOP); // java.lang.Thread[]
+            Assert.that(frame.isStackEmpty());
+            return;
+        }
+
         case Native.com_sun_squawk_platform_MMP$spawnThread: {
             frame.pop(OOP); // java.lang.Thread
             Assert.that(frame.isStackEmpty());
             return;
         }
 
+        case Native.com_sun_squawk_platform_MMP$spawnThreadNear: {
+            frame.pop(OOP); // java.lang.Object
+            frame.pop(INT); // int
+            frame.pop(OOP); // java.lang.Thread
+            Assert.that(frame.isStackEmpty());
+            return;
+        }
+
+        case Native.com_sun_squawk_platform_MMP$steal: {
+            Assert.that(frame.isStackEmpty());
+            return;
+        }
+
+        case Native.com_sun_squawk_platform_MMP$stealReply: {
+            frame.pop(OOP); // java.lang.Thread
+            frame.pop(INT); // int
+            Assert.that(frame.isStackEmpty());
+            return;
+        }
+
         case Native.com_sun_squawk_platform_MMGR$addWaiter: {
             frame.pop(OOP); // java.lang.Object
             Assert.that(frame.isStackEmpty());
             return;
         }
 
+        case Native.com_sun_squawk_platform_MMGR$handoff: {
+            frame.pop(INT); // int
+            frame.pop(INT); // int
+            frame.pop(OOP); // java.lang.Object
+            Assert.that(frame.isStackEmpty());
+            return;
+        }
+
+        case Native.com_sun_squawk_platform_MMGR$managerCount: {
+            Assert.that(frame.isStackEmpty());
+            frame.push(INT); // int
+            return;
+        }
+
+        case Native.com_sun_squawk_platform_MMGR$managerOf: {
+            frame.pop(OOP); // java.lang.Object
+            Assert.that(frame.isStackEmpty());
+            frame.push(INT); // int
+            return;
+        }
+
         case Native.com_sun_squawk_platform_MMGR$monitorEnter: {
             frame.pop(OOP); // java.lang.Object
             Assert.that(frame.isStackEmpty());
             return;
         }
 
+        case Native.com_sun_squawk_platform_MMGR$monitorSlot: {
+            frame.pop(OOP); // java.lang.Object
+            frame.pop(OOP); // int[]
+            Assert.that(frame.isStackEmpty());
+            frame.push(INT); // int
+            return;
+        }
+
         case Native.com_sun_squawk_platform_MMGR$monitorExit: {
             frame.pop(OOP); // java.lang.Object
             Assert.that(frame.isStackEmpty());
@@ -27,76 +27,314 @@
  */
 #include <myrmics.h>
 #include <util.h>
-#include "mmgr.h"
+#include <softcache.h>
+#include "os.h"
+#include "apmgr.h"
 #include "mmp.h"
 #include "globals.h"
 #include "arch.h"
+#include "hwcache.h"
+
+/*
+ * Atomic primitives are executed at the home core of the object they
+ * operate on (see sysHomeOfAddress).  The home core accesses its heap
+ * slice directly, without caching it, and serves the requests one at
+ * a time, so no other copy of the field is ever written.
+ *
+ * Requests are cache-line messages carrying the object, the word
+ * offset of the field, the requesting VMThread, up to two 64-bit
+ * arguments (low word first), the APMGR_* flags and the requester's
+ * write notices.  Replies carry the object, the requesting VMThread,
+ * the previous value of the field (low word first), which is stored in
+ * the thread's atomicValue before signaling the thread's event (see
+ * NativeUnsafe.atomic), and the write notices of the object's slot
+ * (see apmgrNotices).
+ *
+ * Like monitors, atomic primitives order the accesses around them.
+ * Every operation is an acquire: the requester invalidates the
+ * objects homed on the boards in the object's notices once the
+ * operation is done.  Every operation but get is also a release: the
+ * requester writes back its dirty data first, and its notices replace
+ * the object's ones, as the monitor managers do.
+ *
+ * The home core keeps the notices per group of objects, in one of the
+ * APMGR_NOTICE_SLOTS slots of apmgrNotices_g, so that the releases on
+ * one object do not burden the acquires on the others.
+ */
 
 /**
- * Handle a compare-and-swap request.
+ * Returns the write notices slot of the given object.
  *
- * @param bid The board id we got the request from
- * @param cid The core id we got the request from
- * @param object The object on which we were requested to act
- * @param expected The value we expect the object to have
- * @param new The value we want to assign to the object
+ * @param object The object, which must be homed at this core
  */
-void
-apmgrCASHandler (int bid, int cid, Address object,
-                 unsigned int expected, unsigned int new)
+static inline unsigned int*
+apmgrNotices(Address object)
+{
+	UWord key = (UWord)object >> 2;
+
+	return apmgrNotices_g[(key ^ (key >> 6)) & (APMGR_NOTICE_SLOTS - 1)];
+}
+
+/**
+ * Replace the write notices of the given slot with the ones a
+ * releaser holds after its operation's acquire: its cumulative
+ * notices (see SC_NOTICE_WORDS) plus the slot's, which it merges from
+ * our reply.
+ *
+ * @param slot    The slot (see apmgrNotices)
+ * @param notices The releaser's write notices (SC_NOTICE_WORDS words)
+ */
+static inline void
+apmgrRelease(unsigned int *slot, unsigned int *notices)
+{
+	int i;
+
+	for (i = 0; i < SC_NOTICE_WORDS; ++i)
+		slot[i] = notices[i] | slot[i];
+}
+
+/**
+ * Apply an atomic operation on a field of our heap slice.
+ *
+ * @param op     The operation (MMP_OPS_AT_*)
+ * @param object The object, which must be homed at this core
+ * @param offset The offset (in words) of the field
+ * @param arg0   The expected value (CAS), the addend (FAD) or the new
+ *               value (SWAP and SET)
+ * @param arg1   The new value (CAS)
+ * @param flags  APMGR_WIDE for a 64-bit field, APMGR_REF for a
+ *               reference
+ * @return The previous value of the field
+ */
+static inline unsigned long long
+apmgrApply(mmpMsgOp_t op, Address object, int offset, unsigned long long arg0,
+           unsigned long long arg1, int flags)
 {
-	unsigned int tmp, res;
-	Address tmpa;
+	unsigned int       *word;
+	unsigned long long old;
+	unsigned long long new;
 
-	res = 0;
-	tmpa = object;
-	object = (Address)0x04400000; /* Test with an arbitrary address */
-	tmp = *(unsigned int*)object;
+	assume(sc_in_heap(object) && !sc_is_cacheable(object));
 
-	/* kt_printf("This is a CAS(%u, %u) from %d:%d ~ %u\n",
-	 *           expected, new, bid, cid, tmp); */
+	word = (unsigned int*)sc_translate(object, 1) + offset;
 
-	if ( tmp == expected ) {
-		res = 1;
-		*(unsigned int*)object = new;
+	if (flags & APMGR_WIDE) {
+		old = *(unsigned long long*)word;
 	}
-	/* Send back the reply */
-	mmpSend2(bid, cid,
-	         (unsigned int)(res ? MMP_OPS_AT_CAS_ACK : MMP_OPS_AT_CAS_NACK),
-	         (unsigned int)tmpa);
+	else {
+		old  = *word;
+		arg0 = (unsigned int)arg0;
+	}
+
+	switch (op) {
+	case MMP_OPS_AT_CAS:
+		if (old != arg0)
+			return old;
+		new = arg1;
+		break;
+	case MMP_OPS_AT_FAD:
+		new = old + arg0;
+		break;
+	case MMP_OPS_AT_SWAP:
+	case MMP_OPS_AT_SET:
+		new = arg0;
+		break;
+	case MMP_OPS_AT_GET:
+		return old;
+	default:
+		kt_printf("Error: Unknown atomic operator %d\n", (int)op);
+		ar_abort();
+		return old;
+	}
+
+	if (flags & APMGR_WIDE) {
+		*(unsigned long long*)word = new;
+	}
+	else {
+		*word = (unsigned int)new;
+
+		if (flags & APMGR_REF)
+			apmgrWriteBarrier((Address)((unsigned int*)object + offset));
+	}
+
+	/* The others fetch the field from memory, not from our cache */
+	hwcache_flush();
+
+	return old;
 }
 
 /**
- * Handle an atomic set request.
+ * Handle an atomic primitive request at the object's home core.
  *
- * @param bid The board id we got the request from
- * @param cid The core id we got the request from
+ * @param bid    The board id we got the request from
+ * @param cid    The core id we got the request from
+ * @param op     The operation (MMP_OPS_AT_*)
  * @param object The object on which we were requested to act
- * @param new The value we want to assign to the object
+ * @param offset The offset (in words) of the field to act on
+ * @param arg0   The first argument (see apmgrApply)
+ * @param arg1   The second argument (see apmgrApply)
+ * @param flags   The APMGR_* flags
+ * @param thread  The requesting VMThread
+ * @param notices The requester's write notices (SC_NOTICE_WORDS words)
  */
 void
-apmgrSetHandler (int bid, int cid, Address object, unsigned int new)
+apmgrHandler(int bid, int cid, mmpMsgOp_t op, Address object, int offset,
+             unsigned long long arg0, unsigned long long arg1, int flags,
+             Address thread, unsigned int *notices)
 {
-	set_java_lang_Integer_value(object, new);
+	unsigned int       msg[16] __attribute__ ((aligned(MM_CACHELINE_SIZE)));
+	unsigned long long old;
+	mmpMsgOp_t         reply;
+	unsigned int       *slot;
+	int                i;
+
+	old = apmgrApply(op, object, offset, arg0, arg1, flags);
+
+	switch (op) {
+	case MMP_OPS_AT_CAS:
+		if (!(flags & APMGR_WIDE))
+			arg0 = (unsigned int)arg0;
+		reply = (old == arg0) ? MMP_OPS_AT_CAS_ACK : MMP_OPS_AT_CAS_NACK;
+		break;
+	case MMP_OPS_AT_FAD:
+		reply = MMP_OPS_AT_FAD_R;
+		break;
+	case MMP_OPS_AT_SWAP:
+		reply = MMP_OPS_AT_SWAP_R;
+		break;
+	case MMP_OPS_AT_SET:
+		reply = MMP_OPS_AT_SET_R;
+		break;
+	default:
+		reply = MMP_OPS_AT_GET_R;
+		break;
+	}
+
+	/* Send back the reply */
+	msg[0] = reply;
+	msg[1] = (unsigned int)object;
+	msg[2] = (unsigned int)thread;
+	msg[3] = (unsigned int)old;
+	msg[4] = (unsigned int)(old >> 32);
+
+	/* The requester does not need to see its own writes */
+	slot = apmgrNotices(object);
+
+	for (i = 0; i < SC_NOTICE_WORDS; ++i)
+		msg[5 + i] = slot[i];
 
-	/* Send back the reply (ACK) */
-	mmpSend2(bid, cid,
-	         (unsigned int)MMP_OPS_AT_SET_R,
-	         (unsigned int)object);
+	if (op != MMP_OPS_AT_GET)
+		apmgrRelease(slot, notices);
+
+	mmpPost16(bid, cid, msg);
 }
 
 /**
- * Handle an atomic get request.
+ * Store the previous value of a field in the requesting thread.
  *
- * @param bid The board id we got the request from
- * @param cid The core id we got the request from
- * @param object The object on which we were requested to act
+ * @param thread The requesting VMThread
+ * @param value  The previous value of the field
+ */
+static inline void
+apmgrSetResult(Address thread, unsigned long long value)
+{
+	set_com_sun_squawk_VMThread_atomicValue(thread, (int)value);
+	set_com_sun_squawk_VMThread_atomicValueHigh(thread, (int)(value >> 32));
+}
+
+/**
+ * Handle the reply to one of our requests.
+ *
+ * @param object  The object we acted on
+ * @param thread  The requesting VMThread
+ * @param value   The previous value of the field
+ * @param notices The write notices of the object's slot (SC_NOTICE_WORDS
+ *                words)
  */
 void
-apmgrGetHandler (int bid, int cid, Address object)
+apmgrReplyHandler(Address object, Address thread, unsigned long long value,
+                  unsigned int *notices)
 {
-	/* Send back the reply */
-	mmpSend2(bid, cid,
-	         (unsigned int)MMP_OPS_AT_GET_R,
-	         (unsigned int)object);
+	/*
+	 * Our copy of the object was dropped at request, but it might
+	 * have been fetched again while waiting
+	 */
+	sc_invalidate_object(object);
+	/* Acquire, drop what the releasers on the field's home wrote */
+	sc_invalidate(notices);
+	apmgrSetResult(thread, value);
+}
+
+/**
+ * Request an atomic primitive on the given field.  It is executed
+ * right away if we are the object's home core, otherwise it is sent
+ * to the home core and the result is stored in the requesting
+ * thread's atomicValue when the reply arrives (see mmpReceive).
+ *
+ * @param op     The operation (MMP_OPS_AT_*)
+ * @param object The object to act on
+ * @param offset The offset (in words) of the field to act on
+ * @param arg0   The first argument (see apmgrApply)
+ * @param arg1   The second argument (see apmgrApply)
+ * @param flags  The APMGR_* flags
+ * @param thread The requesting VMThread
+ * @return 1 if the operation was executed locally,
+ *         0 if the requesting thread must wait for the reply
+ */
+int
+apmgrRequest(mmpMsgOp_t op, Address object, int offset,
+             unsigned long long arg0, unsigned long long arg1, int flags,
+             Address thread)
+{
+	unsigned int       msg[16] __attribute__ ((aligned(MM_CACHELINE_SIZE)));
+	unsigned long long old;
+	int                bid;
+	int                cid;
+	int                i;
+
+	assume(sc_in_heap(object));
+
+	/* Release, make our writes visible before the field changes */
+	if (op != MMP_OPS_AT_GET)
+		sc_flush(SC_BLOCKING);
+
+	if (!sc_is_cacheable(object)) {
+		old = apmgrApply(op, object, offset, arg0, arg1, flags);
+
+		/* Acquire, drop what the previous releasers wrote */
+		sc_invalidate(apmgrNotices(object));
+
+		if (op != MMP_OPS_AT_GET)
+			apmgrRelease(apmgrNotices(object), cacheNotices_g);
+
+		apmgrSetResult(thread, old);
+
+		return 1;
+	}
+
+	/*
+	 * Write back and drop our copy of the object, so that it neither
+	 * overwrites nor hides the result.
+	 */
+	sc_invalidate_object(object);
+
+	sysHomeOfAddress(object, &bid, &cid);
+
+	msg[0] = MMP_REQUEST(op);
+	msg[1] = (unsigned int)object;
+	msg[2] = offset;
+	msg[3] = (unsigned int)thread;
+	msg[4] = (unsigned int)arg0;
+	msg[5] = (unsigned int)(arg0 >> 32);
+	msg[6] = (unsigned int)arg1;
+	msg[7] = (unsigned int)(arg1 >> 32);
+	msg[8] = flags;
+
+	for (i = 0; i < SC_NOTICE_WORDS; ++i)
+		msg[9 + i] = cacheNotices_g[i];
+
+	/* Heap addresses are tagged with the home board plus one */
+	mmpPost16(bid - 1, cid, msg);
+
+	return 0;
 }
@@ -28,7 +28,24 @@
 #ifndef APMGR_H_
 #define APMGR_H_
 #include <util.h>
+#include <address.h>
+#include "mmp_ops.h"
 
-void apmgrCASHandler(int bid, int cid, Address object, int expected, int new);
+/*
+ * The flags of an atomic primitive request (NativeUnsafe.atomic0 uses
+ * the same values)
+ */
+#define APMGR_WIDE 1 /* The field is 64-bit wide */
+#define APMGR_REF  2 /* The field holds a reference */
+
+int  apmgrRequest(mmpMsgOp_t op, Address object, int offset,
+                  unsigned long long arg0, unsigned long long arg1, int flags,
+                  Address thread);
+void apmgrHandler(int bid, int cid, mmpMsgOp_t op, Address object, int offset,
+                  unsigned long long arg0, unsigned long long arg1, int flags,
+                  Address thread, unsigned int *notices);
+void apmgrReplyHandler(Address object, Address thread,
+                       unsigned long long value, unsigned int *notices);
+void apmgrWriteBarrier(Address ea);
 
 #endif /* APMGR_H_ */
@@ -66,6 +66,7 @@
  * #else */
 
 #include <hwcnt.h>
+#include <topology.h>
 
 /**
  * @brief Global barrier.
@@ -79,7 +80,7 @@
  * |    512  |  22000  |
  */
 void sysBarrierCentralized() {
-	int i, x, y, z, slave_bid;
+	int i, core;
 
 	// Compute how many cores should be activated
 
@@ -97,19 +98,16 @@ void sysBarrierCentralized() {
 		}
 
 		// Re-Initialize the barrier counter
-		ar_cnt_set(my_cid, HWCNT_BARRIER_COUNTER, 1+8-TOTAL_CORES);  // HACK exclude bid 63
+		ar_cnt_set(my_cid, HWCNT_BARRIER_COUNTER, 1 - topoBootedCores());
 
 		// Make Formic slaves reach their boot barrier
-		for (x = AR_FORMIC_MIN_X; x <= AR_FORMIC_MAX_X; x++)
-			for (y = AR_FORMIC_MIN_Y; y <= AR_FORMIC_MAX_Y; y++)
-				for (z = AR_FORMIC_MIN_Z; z <= AR_FORMIC_MAX_Z; z++)
-					for (i = 0; i < AR_FORMIC_CORES_PER_BOARD; i++) {
-						slave_bid = (x << 4) | (y << 2) | z;
+		for (i = 0; i < topoBootedCores(); i++) {
+			core = topoBootedCore(i);
 
-						if (!( ( (slave_bid == my_bid) && (i == my_cid) ) ||
-						       ( (slave_bid >= 63) ) )) // HACK exclude bid 63
-							ar_cnt_incr(my_cid, slave_bid, i, HWCNT_BARRIER_COUNTER, 1);
-					}
+			if (core != TOPO_CORE(my_bid, my_cid))
+				ar_cnt_incr(my_cid, TOPO_BID(core), TOPO_CID(core),
+				            HWCNT_BARRIER_COUNTER, 1);
+		}
 
 	} else { // the slaves
 		// Initialize the local barrier counter
@@ -126,11 +124,17 @@ void sysBarrierCentralized() {
  * @brief Global barrier.
  * Find the proper counter according to our children and parent.
  *
+ * The ranks are the booted cores' ranks (see topoBootedRank).  The
+ * tree is built over the next power of two ranks, so it has
+ * sysBarrierLevels_g = ceil(log2(topoBootedCores())) levels, and the
+ * ranks past topoBootedCores()-1 are padding (see sysBarrierChildren).
+ *
  * @param tree_direction    0 = forward tree (barrier enter),
  *                          1 = reverse tree (barrier exit)
  * @param level             0 = leaf,
- *                          9 = log2(512) = root
- * @param id                rank we're searching for, from 0 to 511
+ *                          sysBarrierLevels_g = root
+ * @param id                rank we're searching for, from 0 to
+ *                          topoBootedCores()-1
  * @param *ret_cnt:         returned counter number (valid for rank and its sibling)
  * @param *ret_id:          returned rank of *ret_cnt
  * @param *ret_sibling_id:  returned rank of sibling in the tree
@@ -144,6 +148,7 @@ static void sysBarrierFindCounter(int tree_direction, int level, int id,
 	int whose;
 	int whose_sibling;
 	int i;
+	int levels = sysBarrierLevels_g;
 
 
 	// Forward tree has no counters for leaves
@@ -151,7 +156,7 @@ static void sysBarrierFindCounter(int tree_direction, int level, int id,
 
 	// Find whose rank's the counter is
 	whose = 0;
-	for (i = 0; i < 9; i++) {
+	for (i = 0; i < levels; i++) {
 		if (i >= level) {
 			whose |= id & (1 << i);
 		}
@@ -160,10 +165,10 @@ static void sysBarrierFindCounter(int tree_direction, int level, int id,
 	// Find its sibling id
 	whose_sibling = whose ^ (1 << level);
 
-	// Expand level so that 0 ... 9 = forward tree, 9 ... 18 = reverse tree
-	// (9 = root for both)
+	// Expand level so that 0 ... levels = forward tree, levels ... 2 *
+	// levels = reverse tree (levels = root for both)
 	if (tree_direction) {
-		exp_level = 9 + (9 - level);
+		exp_level = levels + (levels - level);
 	}
 	else {
 		exp_level = level;
@@ -185,6 +190,19 @@ static void sysBarrierFindCounter(int tree_direction, int level, int id,
 	}
 }
 
+/**
+ * @brief Number of children of a tree node.
+ * The second child of a node is missing if its subtree holds only
+ * padding ranks.
+ *
+ * @param level  The node's level, 1 to sysBarrierLevels_g
+ * @param id     The rank owning the node
+ * @return 2 if both children exist, 1 otherwise
+ */
+static inline int sysBarrierChildren(int level, int id) {
+	return (id + (1 << (level - 1)) < topoBootedCores()) ? 2 : 1;
+}
+
 /**
  * @brief Global barrier initializer.
  * Initialize the variables needed by sysBarrier
@@ -201,6 +219,19 @@ void sysBarrierInit() {
 	int           tmp_cid;
 	int           tmp_sibling;
 	int           id_to_enter;
+	int           core;
+	int           children;
+
+	// The tree is built over the next power of two ranks, the missing
+	// ones are padding and their counters are never set up
+	sysBarrierLevels_g = 0;
+	while ((1 << sysBarrierLevels_g) < topoBootedCores())
+		sysBarrierLevels_g++;
+
+	if (sysBarrierLevels_g == 0) {
+		sysBarrierCentralized();
+		return;
+	}
 
 
 	// Compute which counters comprise our part of the trees, set their
@@ -209,10 +240,11 @@ void sysBarrierInit() {
 	// NOTE: we know it's a maximum of 18 counters per core, so we maintain 2
 	// sets of trees by adding 32 to all computed counter numbers.
 	sysBarrierCounters_g = 0;
-	my_id = (my_bid << 3) | my_cid;
+	my_id = topoBootedRank(TOPO_CORE(my_bid, my_cid));
 
-	// Forward tree: counters wait 2 arrivals and notify next level
-	for (i = 1; i < 9; i++) {
+	// Forward tree: counters wait an arrival per child and notify next
+	// level
+	for (i = 1; i < sysBarrierLevels_g; i++) {
 
 		// Find counter for this tree level
 		sysBarrierFindCounter(0, i, my_id,
@@ -226,51 +258,66 @@ void sysBarrierInit() {
 			                      &tmp_cnt, &tmp_id, NULL);
 
 			// Check if the siblings are enabled in our setup
-			tmp_bid = tmp_id >> 3;
-			tmp_cid = tmp_id & 0x7;
+			core    = topoBootedCore(tmp_id);
+			tmp_bid = TOPO_BID(core);
+			tmp_cid = TOPO_CID(core);
 
 			// Setup our counter
-			ar_cnt_set_notify_cnt(my_cid, cnt, -2,
+			children = sysBarrierChildren(i, my_id);
+			ar_cnt_set_notify_cnt(my_cid, cnt, -children,
 			                      tmp_bid, tmp_cid, tmp_cnt);
-			ar_cnt_set_notify_cnt(my_cid, cnt + 32, -2,
+			ar_cnt_set_notify_cnt(my_cid, cnt + 32, -children,
 			                      tmp_bid, tmp_cid, tmp_cnt + 32);
 
 			// Remember init value
 			sysBarrierCounters2Init_g[sysBarrierCounters_g] = cnt;
-			sysBarrierValues2Init_g[sysBarrierCounters_g] = -2;
+			sysBarrierValues2Init_g[sysBarrierCounters_g] = -children;
 			sysBarrierCounters_g++;
 		}
 
 	}
 
 
-	// Roots of both trees: counter waits 2 arrivals and notifies two
-	// tree siblings
-	sysBarrierFindCounter(0, 9, my_id, &cnt, &id, NULL);
+	// Roots of both trees: counter waits an arrival per child and
+	// notifies the next level siblings that exist
+	sysBarrierFindCounter(0, sysBarrierLevels_g, my_id, &cnt, &id, NULL);
 
 	// Are we responsible for it?
 	if (id == my_id) {
 
 		// Find counters of next tree level siblings
-		sysBarrierFindCounter(1, 8, my_id, &tmp_cnt, &tmp_id, &tmp_sibling);
+		sysBarrierFindCounter(1, sysBarrierLevels_g - 1, my_id,
+		                      &tmp_cnt, &tmp_id, &tmp_sibling);
+		children    = sysBarrierChildren(sysBarrierLevels_g, my_id);
+		tmp_id      = topoBootedCore(tmp_id);
 
 		// Setup our counter
-		ar_cnt_set_dbl_notify_cnt(my_cid, cnt, -2,
-		                          tmp_id >> 3,      tmp_id & 0x7,      tmp_cnt,
-		                          tmp_sibling >> 3, tmp_sibling & 0x7, tmp_cnt);
-		ar_cnt_set_dbl_notify_cnt(my_cid, cnt + 32, -2,
-		                          tmp_id >> 3,      tmp_id & 0x7,      tmp_cnt + 32,
-		                          tmp_sibling >> 3, tmp_sibling & 0x7, tmp_cnt + 32);
+		if (children == 2) {
+			tmp_sibling = topoBootedCore(tmp_sibling);
+			ar_cnt_set_dbl_notify_cnt(my_cid, cnt, -2,
+			                          tmp_id >> 3,      tmp_id & 0x7,      tmp_cnt,
+			                          tmp_sibling >> 3, tmp_sibling & 0x7, tmp_cnt);
+			ar_cnt_set_dbl_notify_cnt(my_cid, cnt + 32, -2,
+			                          tmp_id >> 3,      tmp_id & 0x7,      tmp_cnt + 32,
+			                          tmp_sibling >> 3, tmp_sibling & 0x7, tmp_cnt + 32);
+		}
+		else {
+			ar_cnt_set_notify_cnt(my_cid, cnt, -1,
+			                      tmp_id >> 3, tmp_id & 0x7, tmp_cnt);
+			ar_cnt_set_notify_cnt(my_cid, cnt + 32, -1,
+			                      tmp_id >> 3, tmp_id & 0x7, tmp_cnt + 32);
+		}
 
 		// Remember init value
 		sysBarrierCounters2Init_g[sysBarrierCounters_g] = cnt;
-		sysBarrierValues2Init_g[sysBarrierCounters_g] = -2;
+		sysBarrierValues2Init_g[sysBarrierCounters_g] = -children;
 		sysBarrierCounters_g++;
 	}
 
 
-	// Reverse tree: counter waits 1 arrival and notifies two tree siblings
-	for (i = 8; i >= 1; i--) {
+	// Reverse tree: counter waits 1 arrival and notifies the next level
+	// siblings that exist
+	for (i = sysBarrierLevels_g - 1; i >= 1; i--) {
 
 		// Find counter for this tree level
 		sysBarrierFindCounter(1, i, my_id, &cnt, &id, NULL);
@@ -281,14 +328,24 @@ void sysBarrierInit() {
 			// Find counters of next tree level siblings
 			sysBarrierFindCounter(1, i - 1, my_id,
 			                      &tmp_cnt, &tmp_id, &tmp_sibling);
+			tmp_id      = topoBootedCore(tmp_id);
 
 			// Setup our counter
-			ar_cnt_set_dbl_notify_cnt(my_cid, cnt, -1,
-			                          tmp_id >> 3,      tmp_id & 0x7,      tmp_cnt,
-			                          tmp_sibling >> 3, tmp_sibling & 0x7, tmp_cnt);
-			ar_cnt_set_dbl_notify_cnt(my_cid, cnt + 32, -1,
-			                          tmp_id >> 3,      tmp_id & 0x7,      tmp_cnt + 32,
-			                          tmp_sibling >> 3, tmp_sibling & 0x7, tmp_cnt + 32);
+			if (sysBarrierChildren(i, my_id) == 2) {
+				tmp_sibling = topoBootedCore(tmp_sibling);
+				ar_cnt_set_dbl_notify_cnt(my_cid, cnt, -1,
+				                          tmp_id >> 3,      tmp_id & 0x7,      tmp_cnt,
+				                          tmp_sibling >> 3, tmp_sibling & 0x7, tmp_cnt);
+				ar_cnt_set_dbl_notify_cnt(my_cid, cnt + 32, -1,
+				                          tmp_id >> 3,      tmp_id & 0x7,      tmp_cnt + 32,
+				                          tmp_sibling >> 3, tmp_sibling & 0x7, tmp_cnt + 32);
+			}
+			else {
+				ar_cnt_set_notify_cnt(my_cid, cnt, -1,
+				                      tmp_id >> 3, tmp_id & 0x7, tmp_cnt);
+				ar_cnt_set_notify_cnt(my_cid, cnt + 32, -1,
+				                      tmp_id >> 3, tmp_id & 0x7, tmp_cnt + 32);
+			}
 
 			// Remember init value
 			sysBarrierCounters2Init_g[sysBarrierCounters_g] = cnt;
@@ -302,8 +359,9 @@ void sysBarrierInit() {
 	// Finally, compute which counter we need to notify in order to enter the
 	// barrier...
 	sysBarrierFindCounter(0, 1, my_id, &sysBarrierEnterCounter_g, &id_to_enter, NULL);
-	sysBarrierEnterBID_g = id_to_enter >> 3;
-	sysBarrierEnterCID_g = id_to_enter & 0x7;
+	core                 = topoBootedCore(id_to_enter);
+	sysBarrierEnterBID_g = TOPO_BID(core);
+	sysBarrierEnterCID_g = TOPO_CID(core);
 
 	// ... and which counter to spin onto in order to exit the barrier. We need
 	// to initialize this one too.
@@ -343,6 +401,11 @@ void sysBarrierInit() {
 void sysBarrier() {
 	int           j;
 
+	if (sysBarrierLevels_g == 0) {
+		sysBarrierCentralized();
+		return;
+	}
+
 	// Even or odd phase?
 	if (sysBarrierPhase_g == 0) {
 
@@ -52,13 +52,51 @@ typedef enum {
 	                    * single word mailbox write */
 	HWCNT_MMP_SEND2,   /**< The counter is used to acknowledge a
 	                    * two-word mailbox write */
+	HWCNT_MMP_ASYNC,   /**< The counter is used to acknowledge a
+	                    * non-blocking mailbox write */
 	HWCNT_RESERVED,    /**< The counter is reserved by the VM, i.e.,
 	                    * for the barrier implementation */
+	/* NOTE: Update HWCNT_USAGES in globals.h when adding usages */
 } hwcnt_e;
 
 #include <globals.h>
 
-/* FIXME: OPTIMIZE (consider using lists) */
+/*
+ * The allocated counters are kept in a bitmap (hwcntUsed_g) and,
+ * separately, in one bitmap per usage (hwcntInFlight_g), so that
+ * allocation, reclamation and waiting only touch a handful of words
+ * and the counters that are actually in flight.  The bits of the
+ * reserved counters 126 and 127 in hwcntUsed_g are never looked at.
+ */
+#define HWCNT_LAST_WORD_MASK (~0U << (HWCNT_MAX_COUNTERS & 31))
+
+/**
+ * hwcnt_claim marks the given counter as allocated for the given
+ * usage.
+ *
+ * @param cnt   The counter to allocate
+ * @param usage The usage of the counter
+ */
+INLINE void
+hwcnt_claim (int cnt, hwcnt_e usage)
+{
+	hwcntUsed_g[cnt >> 5]            |= 1U << (cnt & 31);
+	hwcntInFlight_g[usage][cnt >> 5] |= 1U << (cnt & 31);
+	hwcnts_g[cnt]                     = usage;
+}
+
+/**
+ * hwcnt_release marks the given counter as available.
+ *
+ * @param cnt The counter to release
+ */
+INLINE void
+hwcnt_release (int cnt)
+{
+	hwcntInFlight_g[hwcnts_g[cnt]][cnt >> 5] &= ~(1U << (cnt & 31));
+	hwcntUsed_g[cnt >> 5]                    &= ~(1U << (cnt & 31));
+	hwcnts_g[cnt]                             = HWCNT_FREE;
+}
 
 /**
  * hwcnt_next_free detects the next available hardware counter and
@@ -70,50 +108,97 @@ typedef enum {
 INLINE int
 hwcnt_next_free ()
 {
-	int i;
+	unsigned int free;
+	int          i;
+
+	for (i = 0; i < HWCNT_WORDS; ++i) {
+		free = ~hwcntUsed_g[i];
 
-	for (i = 0; i < HWCNT_MAX_COUNTERS; ++i) {
-		if (hwcnts_g[i] == HWCNT_FREE)
-			return i;
+		if (i == HWCNT_WORDS - 1)
+			free &= ~HWCNT_LAST_WORD_MASK;
+
+		if (free)
+			return (i << 5) + __builtin_ctz(free);
 	}
 
 	return -1;
 }
 
+/**
+ * hwcnt_try_get returns an available hardware counter without
+ * blocking.
+ *
+ * @param usage The usage of the counter
+ *
+ * @return An available hardware counter or -1 if there is none
+ */
+INLINE int
+hwcnt_try_get (hwcnt_e usage)
+{
+	int cnt;
+
+	cnt = hwcnt_next_free();
+
+	if (cnt != -1)
+		hwcnt_claim(cnt, usage);
+
+	return cnt;
+}
+
 /**
  * hwcnt_get_free returns an available hardware counter.  Caution,
  * this is a blocking operation since if there is no available
  * hardware counter it will wait for at least one pending transfer to
  * complete.
  *
+ * @param usage The usage of the counter
+ *
  * @return An available hardware counter
  */
 INLINE int
 hwcnt_get_free (hwcnt_e usage)
 {
-	int cnt, i;
+	unsigned int pending;
+	int          cnt, i, u;
 
 	cnt = hwcnt_next_free();
 
 	/*
-	 * If there is no available counter, go through them and check if
-	 * there are any completed transfers
+	 * If there is no available counter, go through the in-flight ones
+	 * and check if there are any completed transfers
 	 */
 	while (cnt == -1) {
-		for (i = 0; i < HWCNT_MAX_COUNTERS; ++i) {
+		for (u = HWCNT_SC_FETCH; u < HWCNT_RESERVED; ++u) {
 			/*
-			 * if the counter is zero the DMA finished and we can use
-			 * the counter
+			 * Prefetch counters are released by the software cache
+			 * at the first use of the prefetched object and
+			 * non-blocking mailbox write counters by mmpPoll, which
+			 * needs them to tell Nacks.
 			 */
-			if (ar_cnt_get(sysGetCore(), i) == 0) {
-				/* Mark the counter as available */
-				hwcnts_g[i] = HWCNT_FREE;
-				cnt         = i;
+			if (u == HWCNT_SC_PREFETCH || u == HWCNT_MMP_ASYNC)
+				continue;
+
+			for (i = 0; i < HWCNT_WORDS; ++i) {
+				pending = hwcntInFlight_g[u][i];
+
+				while (pending) {
+					cnt      = (i << 5) + __builtin_ctz(pending);
+					pending &= pending - 1;
+
+					/*
+					 * if the counter is zero the DMA finished and we
+					 * can use the counter
+					 */
+					if (ar_cnt_get(sysGetCore(), cnt) == 0)
+						hwcnt_release(cnt);
+				}
 			}
 		}
+
+		cnt = hwcnt_next_free();
 	}
 
-	hwcnts_g[cnt] = usage;
+	hwcnt_claim(cnt, usage);
 
 	return cnt;
 }
@@ -128,16 +213,22 @@ hwcnt_get_free (hwcnt_e usage)
 INLINE void
 hwcnt_wait_pending (hwcnt_e reason)
 {
-	int cnt;
+	unsigned int pending;
+	int          cnt, i;
+
+	/* go through the in-flight counters and spin on non zero */
+	for (i = 0; i < HWCNT_WORDS; ++i) {
+		pending = hwcntInFlight_g[reason][i];
+
+		while (pending) {
+			cnt      = (i << 5) + __builtin_ctz(pending);
+			pending &= pending - 1;
 
-	/* go through the counters and spin on non zero */
-	for (cnt = 0; cnt < HWCNT_MAX_COUNTERS; ++cnt) {
-		if (hwcnts_g[cnt] == reason) {
 			while (ar_cnt_get(sysGetCore(), cnt) != 0) {
 				;
 			}
 
-			hwcnts_g[cnt] = HWCNT_FREE;
+			hwcnt_release(cnt);
 		}
 	}
 }
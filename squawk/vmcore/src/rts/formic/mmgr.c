@@ -35,9 +35,11 @@
 /* #define VERY_VERBOSE 1 */
 
 #ifdef MMGR_STATS
-#ifndef MMGR_STATS_PERIOD
-#define MMGR_STATS_PERIOD 1000
-#endif /* ifdef MMGR_STATS_PERIOD */
+/*
+ * Define MMGR_STATS_PERIOD to also print (and reset) the stats every
+ * MMGR_STATS_PERIOD grants, they are otherwise printed on
+ * MMP_OPS_MMGR_PRINT_STATS requests.
+ */
 unsigned int read_locks;
 unsigned int read_lock_reqs;
 unsigned int write_locks;
@@ -46,7 +48,14 @@ unsigned int monitor_enters;
 unsigned int monitor_enter_reqs;
 unsigned int start;
 
+/* Forward declarations */
+static void mmgr_reset_monitor_stats(monitor_t *bst);
+static void mmgr_top_monitors(monitor_t *bst, monitor_t **top, int *n);
+
 void mmgr_reset_stats() {
+	int i;
+
+	mmgrRequests_g = 0;
 	read_locks = 0;
 	read_lock_reqs = 0;
 	write_locks = 0;
@@ -54,16 +63,51 @@ void mmgr_reset_stats() {
 	monitor_enters = 0;
 	monitor_enter_reqs = 0;
 	start = sysGetTicks();
+
+	for (i = 0; i < MMGR_HT_SIZE; ++i) {
+		mmgr_reset_monitor_stats(mmgrHT_g[i]);
+	}
+}
+
+static void mmgr_print_hist(const char *what, int rank, unsigned int *hist) {
+	kt_printf("MMGR_%s | %2d:%1d | %2d | %u %u %u %u %u %u %u %u %u %u %u %u |\n",
+	          what, sysGetIsland(), sysGetCore(), rank,
+	          hist[0], hist[1], hist[2], hist[3], hist[4], hist[5],
+	          hist[6], hist[7], hist[8], hist[9], hist[10], hist[11]);
 }
 
 void mmgr_print_stats() {
 	unsigned int time = sysGetTicks()-start;
-	kt_printf("MMGR_STATS | %2d:%1d | %d/%d | %d/%d | %d/%d | %d |\n",
-	          sysGetIsland(), sysGetCore(),
+	monitor_t    *top[MMGR_STATS_TOP];
+	int          i, n;
+
+	kt_printf("MMGR_STATS | %2d:%1d | %u | %d/%d | %d/%d | %d/%d | %d |\n",
+	          sysGetIsland(), sysGetCore(), mmgrRequests_g,
 	          read_locks, read_lock_reqs,
 	          write_locks, write_lock_reqs,
 	          monitor_enters, monitor_enter_reqs,
 	          time);
+
+	/* Pick the MMGR_STATS_TOP most contended monitors */
+	n = 0;
+	for (i = 0; i < MMGR_HT_SIZE; ++i) {
+		mmgr_top_monitors(mmgrHT_g[i], top, &n);
+	}
+
+	/* One kt_printf per line, since all the managers print at once */
+	for (i = 0; i < n; ++i) {
+		kt_printf("MMGR_PROF | %2d:%1d | %2d | 0x%08X | %s | %u/%u | %u |"
+		          " %u | %u |\n",
+		          sysGetIsland(), sysGetCore(), i,
+		          (unsigned int)top[i]->object,
+		          top[i]->name[0] ? top[i]->name : "?",
+		          top[i]->times_acquired, top[i]->times_requested,
+		          top[i]->max_queued, top[i]->wait_time,
+		          top[i]->hold_time);
+		mmgr_print_hist("WAIT", i, top[i]->wait_hist);
+		mmgr_print_hist("HOLD", i, top[i]->hold_hist);
+	}
+
 	mmgr_reset_stats();
 }
 #endif  /* MMGR_STATS */
@@ -227,9 +271,18 @@ bst_remove_child(monitor_t *child)
 		child->object  = tmp->object;
 		child->owner   = tmp->owner;
 		child->waiters = tmp->waiters;
+		child->notices[0] = tmp->notices[0];
+		child->notices[1] = tmp->notices[1];
+		child->revoked = tmp->revoked;
+		child->tenure  = tmp->tenure;
 #ifdef MMGR_QUEUE
 		child->pending = tmp->pending;
 #endif /* ifdef MMGR_QUEUE */
+#ifdef MMGR_STATS
+		/* The profile lives at the end of monitor_t */
+		kt_memcpy(&child->times_acquired, &tmp->times_acquired,
+		          (char*)(tmp + 1) - (char*)&tmp->times_acquired);
+#endif /* ifdef MMGR_STATS */
 		child->lchild  = bst_remove(child->lchild, child->object);
 
 		return child;
@@ -319,7 +372,7 @@ ht_hash(Address object)
 
 	/*
 	 * Drop 6 LS bits, Objects are cache aligned
-	 * Keep the next 3 LS bits and drop the 3 after them (see mmgrGetManager)
+	 * Keep the next 3 LS bits and drop the 3 after them
 	 */
 	res = (unsigned int)object;
 	res = ((res >> 12) << 3) | ((res >> 6) & 0x8);
@@ -472,6 +525,9 @@ q_enqueue(wait_queue_t *queue, unsigned int id)
 
 	waiter->id   = id;
 	waiter->next = NULL;
+#ifdef MMGR_STATS
+	waiter->since = sysGetTicks();
+#endif /* ifdef MMGR_STATS */
 
 	/* Append to the end of the list */
 	if (likely(queue->tail == NULL)) {
@@ -571,6 +627,175 @@ q_peek(wait_queue_t *queue)
 	return queue->head->id;
 }
 
+#ifdef MMGR_STATS
+/******************************************************************************
+ * Contention profile
+ ******************************************************************************/
+
+/**
+ * Find the histogram bucket of the given time (see MMGR_HIST_SHIFT).
+ *
+ * @param ticks The time in sysGetTicks() cycles
+ * @return The bucket's index
+ */
+static inline int
+mmgr_hist_bucket(unsigned int ticks)
+{
+	int bucket;
+
+	ticks >>= MMGR_HIST_SHIFT;
+
+	for (bucket = 0; ticks && bucket < MMGR_HIST_BUCKETS - 1; ++bucket)
+		ticks >>= 1;
+
+	return bucket;
+}
+
+/**
+ * Account a requester queued for the given monitor.
+ *
+ * @param monitor The monitor
+ */
+static inline void
+mmgr_stats_enqueue(monitor_t *monitor)
+{
+	monitor->queued++;
+
+	if (monitor->queued > monitor->max_queued)
+		monitor->max_queued = monitor->queued;
+}
+
+/**
+ * Account the next requester leaving the given monitor's pending
+ * queue, if any.
+ *
+ * @param monitor The monitor
+ * @return When the next requester was queued or
+ *         the current time if there is none
+ */
+static inline unsigned int
+mmgr_stats_dequeue(monitor_t *monitor)
+{
+	if (monitor->pending.head == NULL)
+		return sysGetTicks();
+
+	monitor->queued--;
+
+	return monitor->pending.head->since;
+}
+
+/**
+ * Account a grant of the given monitor.
+ *
+ * @param monitor The monitor
+ * @param since   When the new owner requested it
+ */
+static inline void
+mmgr_stats_grant(monitor_t *monitor, unsigned int since)
+{
+	unsigned int now = sysGetTicks();
+
+	monitor_enters++;
+	monitor->times_acquired++;
+	monitor->acquired_at = now;
+	monitor->wait_time  += now - since;
+	monitor->wait_hist[mmgr_hist_bucket(now - since)]++;
+}
+
+/**
+ * Account a release of the given monitor.
+ *
+ * @param monitor The monitor
+ */
+static inline void
+mmgr_stats_release(monitor_t *monitor)
+{
+	unsigned int held = sysGetTicks() - monitor->acquired_at;
+
+	monitor->hold_time += held;
+	monitor->hold_hist[mmgr_hist_bucket(held)]++;
+}
+
+/**
+ * Reset the contention profile of all the monitors in bst.
+ *
+ * @param bst The binary search root
+ */
+static void
+mmgr_reset_monitor_stats(monitor_t *bst)
+{
+	while (bst) {
+		bst->times_acquired  = 0;
+		bst->times_requested = 0;
+		bst->hold_time       = 0;
+		bst->wait_time       = 0;
+		bst->max_queued      = bst->queued;
+		kt_memset(bst->hold_hist, 0, sizeof(bst->hold_hist));
+		kt_memset(bst->wait_hist, 0, sizeof(bst->wait_hist));
+
+		mmgr_reset_monitor_stats(bst->lchild);
+		bst = bst->rchild;
+	}
+}
+
+/**
+ * Add the requested monitors of bst to top, keeping it sorted by the
+ * total time requesters waited for them.
+ *
+ * @param bst The binary search root
+ * @param top The most contended monitors so far (up to
+ *            MMGR_STATS_TOP)
+ * @param n   The number of monitors in top (updated)
+ */
+static void
+mmgr_top_monitors(monitor_t *bst, monitor_t **top, int *n)
+{
+	int i;
+
+	while (bst) {
+		mmgr_top_monitors(bst->lchild, top, n);
+
+		if (bst->times_requested) {
+			/* Insertion sort, dropping the last one if full */
+			for (i = *n; i > 0 && top[i - 1]->wait_time < bst->wait_time;
+			     --i) {
+				if (i < MMGR_STATS_TOP)
+					top[i] = top[i - 1];
+			}
+
+			if (i < MMGR_STATS_TOP) {
+				top[i] = bst;
+
+				if (*n < MMGR_STATS_TOP)
+					(*n)++;
+			}
+		}
+
+		bst = bst->rchild;
+	}
+}
+
+/**
+ * Record the class name of the given object, as sent by its
+ * releasers (see mmgrRequestNotices).
+ *
+ * @param object The object
+ * @param name   The first MMGR_NAME_SIZE bytes of its class name
+ */
+void
+mmgrNameMonitor(Address object, const char *name)
+{
+	monitor_t *monitor;
+
+	monitor = ht_lookup(object);
+
+	if (monitor != NULL && monitor->name[0] == '\0') {
+		kt_memcpy(monitor->name, name, MMGR_NAME_SIZE);
+		monitor->name[MMGR_NAME_SIZE] = '\0';
+	}
+}
+#endif /* ifdef MMGR_STATS */
+
 /******************************************************************************
  * Interface Implementation (Client side)
  ******************************************************************************/
@@ -583,55 +808,124 @@ q_peek(wait_queue_t *queue)
 void
 mmgrInitialize(mmgrGlobals *globals)
 {
-	*(unsigned int*)0x04400000 = 0;
 	mmgr_g                     = globals;
 	mmgrWaiterFreeNodes_g      = NULL;
 	mmgrMonitorFreeNodes_g     = NULL;
-#ifdef ARCH_MB
+	mmgrRequests_g             = 0;
+#if defined(ARCH_MB) && MMGR_PLACEMENT == MMGR_PLACE_BOARD
 	mmgrAllocTop_g             = (Address) mm_slice_base(sysGetCore());
 	mmgrAllocEnd_g             = mmgrAllocTop_g + MM_MB_SLICE_SIZE;
-#else /* ifdef ARCH_MB */
+#elif defined(ARCH_MB)
+	/* The VM uses the rest of the slice (see MMGR_ARENA_SIZE) */
+	mmgrAllocEnd_g             = (Address) mm_slice_base(sysGetCore()) +
+	                             MM_MB_SLICE_SIZE;
+	mmgrAllocTop_g             = mmgrAllocEnd_g - MMGR_ARENA_SIZE;
+#else /* if defined(ARCH_MB) && MMGR_PLACEMENT == MMGR_PLACE_BOARD */
 	mmgrAllocTop_g             = (Address) mm_pa_kernel_base(sysGetCore());
 	mmgrAllocEnd_g             = mmgrAllocTop_g + MM_PA_KERNEL_SIZE;
-#endif /* ifdef ARCH_MB */
+#endif /* if defined(ARCH_MB) && MMGR_PLACEMENT == MMGR_PLACE_BOARD */
 
 	kt_memset(mmgrHT_g, 0, sizeof(monitor_t*) * MMGR_HT_SIZE);
 	mmgr_reset_stats();
 }
 
 /**
- * Find the manager responsible for the given object.
+ * Returns the number of monitor managers.
  *
- * @param hash   The object's hash
- * @param bid    The manager's bid (return)
- * @param cid    The manager's cid (return)
+ * @return The number of monitor managers
  */
-static inline void
-mmgrGetManager(unsigned int hash, int *bid, int *cid)
+int
+mmgrManagerCount()
 {
-	/* We need only 3 bits since we have 2^3 monitor managers */
-	unsigned int id3;
-
-	/* TODO: Out-dated comment
-	 * Objects are cache line aligned so we can ignore the 6 LS bits
-	 * Then skip the next 3 bits so that neighbor objects don't end at the same
-	 * monitor manager
-	 */
-	/* TODO: Use something that distributes objects from the same core as well */
-	id3 = (hash >> 15) & 0x7;
-
-#ifdef MMGR_ON_ARM
+#if MMGR_PLACEMENT == MMGR_PLACE_HOME
+	return topoCores();
+#elif MMGR_PLACEMENT == MMGR_PLACE_SPREAD
+	return (topoCores() < MMGR_MANAGERS) ? topoCores() : MMGR_MANAGERS;
+#else /* MMGR_PLACEMENT == MMGR_PLACE_HOME */
+	return MMGR_MANAGERS;
+#endif /* MMGR_PLACEMENT == MMGR_PLACE_HOME */
+}
 
-	if (id3 & 1)
+/**
+ * Find the core running the given monitor manager.
+ *
+ * @param index The manager's index (0 to mmgrManagerCount()-1)
+ * @param bid   The manager's bid (return)
+ * @param cid   The manager's cid (return)
+ */
+void
+mmgrManagerOf(int index, int *bid, int *cid)
+{
+#if MMGR_PLACEMENT == MMGR_PLACE_SPREAD
+	/* Fill core 0 of every board first, then core 1, and so on */
+	*bid = topoBoard(index % topoBoards());
+	*cid = index / topoBoards();
+#elif MMGR_PLACEMENT == MMGR_PLACE_HOME
+	int core = topoCore(index);
+
+	*bid = TOPO_BID(core);
+	*cid = TOPO_CID(core);
+#elif defined(MMGR_ON_ARM)
+	if (index & 1)
 		*bid = 0x4B;
 	else
 		*bid = 0x6B;
 
-	*cid = id3 >> 1;
-#else /* MMGR_ON_ARM */
-	*bid = 0x3F;
-	*cid = id3;
-#endif /* MMGR_ON_ARM */
+	*cid = index >> 1;
+#else /* MMGR_PLACEMENT == MMGR_PLACE_SPREAD */
+	*bid = MMGR_BOARD;
+	*cid = index;
+#endif /* MMGR_PLACEMENT == MMGR_PLACE_SPREAD */
+}
+
+/**
+ * Find the index of the manager responsible for the given object.
+ *
+ * @param object The object's global address
+ * @return The manager's index (0 to mmgrManagerCount()-1)
+ */
+int
+mmgrGetManagerIndex(Address object)
+{
+	unsigned int addr = (unsigned int)object;
+
+#if MMGR_PLACEMENT == MMGR_PLACE_HOME
+	int index;
+
+	/*
+	 * Heap addresses are tagged with their home board (plus one) and
+	 * core (see sysHomeOfAddress).  Objects out of the heap (e.g. in
+	 * ROM) or homed on inactive cores are spread over all the active
+	 * cores.
+	 */
+	if (addr >> 26) {
+		index = topoIndex(TOPO_CORE((addr >> 26) - 1, (addr >> 23) & 0x7));
+		if (index >= 0)
+			return index;
+	}
+
+	return ((addr * 2654435761U) >> 16) % topoCores();
+#else /* MMGR_PLACEMENT == MMGR_PLACE_HOME */
+	/*
+	 * The high bits of the address are its home board and core, so
+	 * mix them all (Knuth's multiplicative hashing) before picking a
+	 * manager.
+	 */
+	return ((addr * 2654435761U) >> 16) % mmgrManagerCount();
+#endif /* MMGR_PLACEMENT == MMGR_PLACE_HOME */
+}
+
+/**
+ * Find the manager responsible for the given object.
+ *
+ * @param object The object's global address
+ * @param bid    The manager's bid (return)
+ * @param cid    The manager's cid (return)
+ */
+static inline void
+mmgrGetManager(Address object, int *bid, int *cid)
+{
+	mmgrManagerOf(mmgrGetManagerIndex(object), bid, cid);
 }
 
 #ifdef ARCH_MB
@@ -640,42 +934,44 @@ mmgrGetManager(unsigned int hash, int *bid, int *cid)
  * manager is automatically calculated and the request is sent using a
  * 2-word mailbox message.
  *
+ * Objects are identified by their global address, which is also the
+ * key of the monitor manager's hashtable.
+ *
  * @param msg_op The desired operation
  * @param object The object to operate on
  */
-static inline void
+void
 mmgrRequest(mmpMsgOp_t msg_op, Address object)
 {
 	unsigned int msg0;
 	int          target_cid;
 	int          target_bid;
-	unsigned int hash;
-
-	hash = java_lang_Object_hashCode(object);
 
 	/*
 	 * Pass your bid and cid with the opcode so that the other end
 	 * can check the owner.
 	 */
-	msg0 = (sysGetIsland() << 19) | (sysGetCore() << 16) | msg_op;
+	msg0 = MMP_REQUEST(msg_op);
 
-	mmgrGetManager(hash, &target_bid, &target_cid);
+	mmgrGetManager(object, &target_bid, &target_cid);
 
-	mmpSend2(target_bid, target_cid, msg0, hash);
+	mmpPost2(target_bid, target_cid, msg0, (unsigned int)object);
 }
 
 /**
- * Send a msg_op request regarding the object associated with the
- * given hash.  The responsible manager is automatically calculated
- * and the request is sent using a 2-word mailbox message.
+ * Send a release msg_op request regarding the given object along with
+ * our write notices.  The responsible manager is automatically
+ * calculated and the request is sent using a cache-line mailbox
+ * message.
  *
  * @param msg_op The desired operation
- * @param hash   The hash of the object to operate on
+ * @param object The object to operate on
+ * @param arg    An extra argument for the manager
  */
-void
-mmgrRequestHash(mmpMsgOp_t msg_op, unsigned int hash)
+static inline void
+mmgrRequestNotices(mmpMsgOp_t msg_op, Address object, int arg)
 {
-	unsigned int msg0;
+	unsigned int msg[16] __attribute__ ((aligned(MM_CACHELINE_SIZE)));
 	int          target_cid;
 	int          target_bid;
 
@@ -683,11 +979,59 @@ mmgrRequestHash(mmpMsgOp_t msg_op, unsigned int hash)
 	 * Pass your bid and cid with the opcode so that the other end
 	 * can check the owner.
 	 */
-	msg0 = (sysGetIsland() << 19) | (sysGetCore() << 16) | msg_op;
+	msg[0] = MMP_REQUEST(msg_op);
+	msg[1] = (unsigned int)object;
+	msg[2] = cacheNotices_g[0];
+	msg[3] = cacheNotices_g[1];
+	msg[4] = arg;
+#ifdef MMGR_STATS
+	/* Name the monitor in the manager's contention profile */
+	kt_memset(&msg[5], 0, MMGR_NAME_SIZE);
+	mmgrKlassName(object, (char*)&msg[5], MMGR_NAME_SIZE);
+#endif /* ifdef MMGR_STATS */
+
+	mmgrGetManager(object, &target_bid, &target_cid);
+
+	mmpPost16(target_bid, target_cid, msg);
+}
+
+/**
+ * Hand a monitor we are asked to give back (see mmgrRevoke) directly
+ * to the next requester.  The monitor manager is informed first, so
+ * that it sees the handoff before any request of the new owner.  The
+ * new owner then gets the grant straight from us, without waiting
+ * for the manager to serve our exit.
+ *
+ * @param object    The object whose monitor to hand off
+ * @param successor The next owner's id packed as (board_ID << 3) |
+ *                  (core_ID)
+ * @param tenure    The new owner's tenure (see monitor_t)
+ */
+void
+mmgrHandoff(Address object, int successor, unsigned int tenure)
+{
+	unsigned int msg[16] __attribute__ ((aligned(MM_CACHELINE_SIZE)));
+
+#  ifdef VERY_VERBOSE
+	kt_printf("I hand off %p to %d:%d\n", object, successor >> 3,
+	          successor & 7);
+	ar_uart_flush();
+#  endif /* ifdef VERY_VERBOSE */
+
+	/* Write back any dirty data */
+	sc_flush(SC_BLOCKING);
+
+	msg[0] = (successor << 16) | MMP_OPS_MNTR_ACK;
+	msg[1] = (unsigned int)object;
+	msg[2] = cacheNotices_g[0];
+	msg[3] = cacheNotices_g[1];
+	msg[4] = tenure;
 
-	mmgrGetManager(hash, &target_bid, &target_cid);
+	mmgrRequestNotices(MMP_OPS_MNTR_HANDOFF, object, successor);
+	/* The manager must see the handoff before the new owner's requests */
+	mmpFence();
 
-	mmpSend2(target_bid, target_cid, msg0, hash);
+	mmpPost16(successor >> 3, successor & 0x7, msg);
 }
 
 /**
@@ -707,11 +1051,11 @@ mmgrMonitorEnter(Address object)
 	assume(sc_in_heap(object));
 	mmgrRequest(MMP_OPS_MNTR_ENTER, object);
 
-	/* Empty our software cache.  There is no need to for writing back any
-	dirty
-	 * data, since they should be the result of a data race */
-	/* sc_flush(); */
-	sc_clear();
+	/*
+	 * The stale cached objects are invalidated when the ACK arrives,
+	 * according to the write notices it carries (see
+	 * mmpReceive).
+	 */
 
 	/*
 	 * Remove me from the runnable threads and add me to the blocked
@@ -736,7 +1080,7 @@ mmgrMonitorExit(Address object)
 	sc_flush(SC_BLOCKING);
 
 	/* assume(sc_in_heap(object)); */
-	mmgrRequest(MMP_OPS_MNTR_EXIT, object);
+	mmgrRequestNotices(MMP_OPS_MNTR_EXIT, object, 0);
 }
 
 /**
@@ -757,7 +1101,7 @@ mmgrWaitMonitorExit(Address object)
 	sc_flush(SC_BLOCKING);
 
 /*	assume(sc_in_heap(object)); */
-	mmgrRequest(MMP_OPS_MNTR_WAIT, object);
+	mmgrRequestNotices(MMP_OPS_MNTR_WAIT, object, 0);
 }
 
 /**
@@ -827,6 +1171,10 @@ mmgrGetMonitor(Address object)
 {
 	monitor_t *res;
 
+#ifdef MMGR_STATS
+	mmgrRequests_g++;
+#endif /* ifdef MMGR_STATS */
+
 	/* Look-up the object's monitor */
 	res = ht_lookup(object);
 
@@ -844,9 +1192,14 @@ mmgrGetMonitor(Address object)
 #endif /* ifdef MMGR_QUEUE */
 		res->lchild          = NULL;
 		res->rchild          = NULL;
+		res->notices[0]      = 0;
+		res->notices[1]      = 0;
+		res->revoked         = 0;
+		res->tenure          = 0;
 #ifdef MMGR_STATS
-		res->times_acquired  = 0;
-		res->times_requested = 0;
+		res->queued          = 0;
+		res->name[0]         = '\0';
+		mmgr_reset_monitor_stats(res);
 #endif /* ifdef MMGR_STATS */
 		res->object          = object;
 		ht_insert(res);
@@ -859,6 +1212,69 @@ mmgrGetMonitor(Address object)
  * Interface Implementation (Server side)
  ******************************************************************************/
 
+/**
+ * Send an acquire reply (ACK) for the given monitor.  The reply is a
+ * cache-line mailbox message carrying the write notices of the
+ * monitor's releases, so that the acquirer invalidates only the
+ * possibly stale objects in its software cache.
+ *
+ * @param bid     The board id to send the reply to
+ * @param cid     The core id to send the reply to
+ * @param msg0    The first word (owner and opcode)
+ * @param monitor The monitor being acquired
+ */
+static inline void
+mmgrGrant(int bid, int cid, unsigned int msg0, monitor_t *monitor)
+{
+	unsigned int msg[16] __attribute__ ((aligned(MM_CACHELINE_SIZE)));
+
+	msg[0] = msg0;
+	msg[1] = (unsigned int)monitor->object;
+	msg[2] = monitor->notices[0];
+	msg[3] = monitor->notices[1];
+	msg[4] = monitor->tenure;
+
+	mmpPost16(bid, cid, msg);
+}
+
+/**
+ * Ask the owner of the given monitor to give it back.
+ *
+ * Cores keep a lease on the monitors they release (see
+ * VMThread.releaseMonitor), so that their threads can re-acquire them
+ * without contacting us.  We only learn that a monitor is free when
+ * its owner sends the exit request after a revoke.  Revokes are sent
+ * once per ownership.
+ *
+ * The revoke is a cache-line message carrying the owner's tenure, to
+ * tell stale revokes, and the next requester, so that the owner can
+ * hand the monitor to it directly (see mmgrHandoff).
+ *
+ * @param monitor The monitor to revoke
+ */
+static inline void
+mmgrRevoke(monitor_t *monitor)
+{
+	unsigned int msg[16] __attribute__ ((aligned(MM_CACHELINE_SIZE)));
+
+	if (monitor->revoked)
+		return;
+
+	monitor->revoked = 1;
+
+	msg[0] = (monitor->owner << 16) | MMP_OPS_MNTR_REVOKE;
+	msg[1] = (unsigned int)monitor->object;
+	msg[2] = monitor->tenure;
+#ifdef MMGR_QUEUE
+	msg[3] = q_peek(&monitor->pending);
+#else /* ifdef MMGR_QUEUE */
+	/* Requesters retry, there is no one to hand it off to */
+	msg[3] = -1;
+#endif /* ifdef MMGR_QUEUE */
+
+	mmpPost16(monitor->owner >> 3, monitor->owner & 0x7, msg);
+}
+
 /**
  * Handle a monitor enter request.
  *
@@ -879,32 +1295,26 @@ mmgrMonitorEnterHandler(int bid, int cid, Address object)
 #ifdef MMGR_STATS
 	monitor_enter_reqs++;
 	monitor->times_requested++;
+#ifdef MMGR_STATS_PERIOD
 	if (monitor_enters == MMGR_STATS_PERIOD) {
 		mmgr_print_stats();
 	}
+#endif /* ifdef MMGR_STATS_PERIOD */
 #endif /* ifdef MMGR_STATS */
 
 	/* If the monitor is available acquire it */
 	if (monitor->owner == -1) {
-		monitor->owner = (bid << 3) | cid;
+		monitor->owner   = (bid << 3) | cid;
+		monitor->revoked = 0;
+		monitor->tenure++;
 
 #ifdef MMGR_STATS
-		monitor_enters++;
+		mmgr_stats_grant(monitor, sysGetTicks());
 #endif  /* MMGR_STATS */
 		/* Reply back with the owner */
-		mmpSend2(bid, cid,
-		         (unsigned int)((monitor->owner << 16) | MMP_OPS_MNTR_ACK),
-		         (unsigned int)object);
-
-#ifdef MMGR_STATS
-		monitor->times_acquired++;
-		// Periodically print stats
-		/* if ((monitor->times_acquired & 63) == 0) {
-		 * 	printf("Monitor: %p Manager: %d Requested: %u Acquired: %u\n",
-		 * 	       monitor->object, sysGetCore(),
-		 * 	       monitor->times_requested, monitor->times_acquired);
-		 * } */
-#endif /* ifdef MMGR_STATS */
+		mmgrGrant(bid, cid,
+		          (unsigned int)((monitor->owner << 16) | MMP_OPS_MNTR_ACK),
+		          monitor);
 	}
 	else {
 		/* kt_printf("NOT Available %p at %u from %d: %d\n",
@@ -915,12 +1325,21 @@ mmgrMonitorEnterHandler(int bid, int cid, Address object)
 		 * waiting for this monitor */
 		/* kt_printf("Queued enter request\n"); */
 		q_enqueue(&monitor->pending, (bid << 3) | cid);
-#else /* ifdef MMGR_QUEUE */
-		/* Reply back with the owner */
-		mmpSend2(bid, cid,
-		         (unsigned int)((monitor->owner << 16) | MMP_OPS_MNTR_ACK),
-		         (unsigned int)object);
+#ifdef MMGR_STATS
+		mmgr_stats_enqueue(monitor);
+#endif /* ifdef MMGR_STATS */
 #endif /* ifdef MMGR_QUEUE */
+
+		/* The owner might just hold a lease on it */
+		if (monitor->owner != ((bid << 3) | cid))
+			mmgrRevoke(monitor);
+
+#ifndef MMGR_QUEUE
+		/* Reply back with the owner */
+		mmgrGrant(bid, cid,
+		          (unsigned int)((monitor->owner << 16) | MMP_OPS_MNTR_ACK),
+		          monitor);
+#endif /* ifndef MMGR_QUEUE */
 	}
 
 #ifdef VERY_VERBOSE
@@ -936,13 +1355,18 @@ mmgrMonitorEnterHandler(int bid, int cid, Address object)
  * @param bid    The board id we got the request from
  * @param cid    The core id we got the request from
  * @param object The object on which we were requested to act
- * @param iswait Whether this exit is a result of a wait() call
+ * @param iswait  Whether this exit is a result of a wait() call
+ * @param notices The releaser's write notices
  */
 void
-mmgrMonitorExitHandler(int bid, int cid, Address object, int iswait)
+mmgrMonitorExitHandler(int bid, int cid, Address object, int iswait,
+                       unsigned int *notices)
 {
-	monitor_t *monitor;
-	int       id;
+	monitor_t    *monitor;
+	int          id;
+#if defined(MMGR_STATS) && defined(MMGR_QUEUE)
+	unsigned int since;
+#endif /* if defined(MMGR_STATS) && defined(MMGR_QUEUE) */
 
 	monitor = mmgrGetMonitor(object);
 
@@ -955,25 +1379,48 @@ mmgrMonitorExitHandler(int bid, int cid, Address object, int iswait)
 
 	ar_assert(monitor->owner == ((bid << 3) | cid));
 
+#ifdef MMGR_STATS
+	mmgr_stats_release(monitor);
+#endif /* ifdef MMGR_STATS */
+
+	/*
+	 * The releaser's notices are cumulative and it acquired the
+	 * monitor's notices before, so they replace them (see
+	 * SC_NOTICE_WORDS).
+	 */
+	monitor->notices[0] = notices[0];
+	monitor->notices[1] = notices[1];
+
 	if (iswait) {
 		mmgrAddWaiterHandler(bid, cid, object);
 	}
 
 #ifdef MMGR_QUEUE
 
+#ifdef MMGR_STATS
+	since = mmgr_stats_dequeue(monitor);
+#endif /* ifdef MMGR_STATS */
+
 	/* If there are pending threads give monitor to the next pending
 	 * thread */
 	if ((id = q_dequeue(&monitor->pending)) != -1) {
 		/* kt_printf("There are pending monitors %p\n"); */
 #ifdef MMGR_STATS
-		monitor_enters++;
+		mmgr_stats_grant(monitor, since);
 #endif /* ifdef MMGR_STATS */
-		monitor->owner = id;
-		bid            = id >> 3;
-		cid            = id & 0x7;
-		mmpSend2(bid, cid,
-		         (unsigned int)((monitor->owner << 16) | MMP_OPS_MNTR_ACK),
-		         (unsigned int)object);
+		monitor->owner   = id;
+		monitor->revoked = 0;
+		monitor->tenure++;
+		bid              = id >> 3;
+		cid              = id & 0x7;
+		mmgrGrant(bid, cid,
+		          (unsigned int)((monitor->owner << 16) | MMP_OPS_MNTR_ACK),
+		          monitor);
+
+		/* Do not let it keep a lease if others are waiting as well */
+		if (q_peek(&monitor->pending) != -1 &&
+		    q_peek(&monitor->pending) != id)
+			mmgrRevoke(monitor);
 	}
 	else {
 		monitor->owner = -1;
@@ -987,6 +1434,55 @@ mmgrMonitorExitHandler(int bid, int cid, Address object, int iswait)
 	 * waiting threads */
 }                  /* mmgrMonitorExitHandler */
 
+/**
+ * Handle a monitor handoff, the owner granted the monitor to the next
+ * requester on its own (see mmgrHandoff).
+ *
+ * @param bid       The board id we got the request from
+ * @param cid       The core id we got the request from
+ * @param object    The object on which we were requested to act
+ * @param successor The new owner
+ * @param notices   The releaser's write notices
+ */
+void
+mmgrHandoffHandler(int bid, int cid, Address object, int successor,
+                   unsigned int *notices)
+{
+	monitor_t *monitor;
+	int       id;
+
+	monitor = mmgrGetMonitor(object);
+
+#ifdef VERY_VERBOSE
+	kt_printf("I got a handoff for %p from %d:%d to %d:%d\n",
+	          object, bid, cid, successor >> 3, successor & 7);
+#endif /* ifdef VERY_VERBOSE */
+
+	ar_assert(monitor->owner == ((bid << 3) | cid));
+
+	/* Replace them, see mmgrMonitorExitHandler */
+	monitor->notices[0] = notices[0];
+	monitor->notices[1] = notices[1];
+
+#ifdef MMGR_STATS
+	mmgr_stats_release(monitor);
+	mmgr_stats_grant(monitor, mmgr_stats_dequeue(monitor));
+#endif /* ifdef MMGR_STATS */
+
+	/* The successor was the first pending requester when revoked */
+	id = q_dequeue(&monitor->pending);
+	ar_assert(id == successor);
+
+	monitor->owner   = successor;
+	monitor->revoked = 0;
+	monitor->tenure++;
+
+	/* Do not let it keep a lease if others are waiting as well */
+	if (q_peek(&monitor->pending) != -1 &&
+	    q_peek(&monitor->pending) != successor)
+		mmgrRevoke(monitor);
+}
+
 /**
  * Handle a remove waiter request.
  *
@@ -1091,7 +1587,7 @@ mmgrNotifyHandler(int bid, int cid, Address object, int all)
 		 * identifier even if it appears multiple times in the waiters
 		 * queue.
 		 */
-		mmpSend2(bid, cid,
+		mmpPost2(bid, cid,
 		         (unsigned int)(monitor->owner << 16 |
 		                        all ? MMP_OPS_MNTR_NOTIFICATION_ALL :
 		                        MMP_OPS_MNTR_NOTIFICATION),
@@ -1138,15 +1634,11 @@ mmgrWriteLock(Address object, int istry)
 
 	mmgrRequest(istry ? MMP_OPS_RW_WRITE_TRY : MMP_OPS_RW_WRITE, object);
 
-	/* If it is a try only empty our cache if we manage to acquire the lock
+	/*
+	 * The stale cached objects are invalidated only if we manage to
+	 * acquire the lock, according to the write notices of the ACK
+	 * (see mmpReceive).
 	 */
-	/* if (!istry) { */
-	 /* Empty our software cache.  There is no need to for writing back any
-	  * dirty
-	  * data, since they should be the result of a data race */
-	 /* sc_flush(SC_BLOCKING); */
-	 sc_clear();
-	/* } */
 }
 
 /**
@@ -1166,15 +1658,11 @@ mmgrReadLock(Address object, int istry)
 
 	mmgrRequest(istry ? MMP_OPS_RW_READ_TRY : MMP_OPS_RW_READ, object);
 
-	/* If it is a try only empty our cache if we manage to acquire the lock
-	*/
-	/* if (!istry) { */
-	 /* Empty our software cache.  There is no need to for writing back any
-	  * dirty
-	  * data, since they should be the result of a data race */
-	 /* sc_flush(); */
-	 sc_clear();
-	/* } */
+	/*
+	 * The stale cached objects are invalidated only if we manage to
+	 * acquire the lock, according to the write notices of the ACK
+	 * (see mmpReceive).
+	 */
 }
 
 /**
@@ -1197,8 +1685,11 @@ mmgrRWunlock(Address object, int isread)
 		sc_flush(SC_BLOCKING);
 	}
 
-	mmgrRequest(isread ? MMP_OPS_RW_READ_UNLOCK : MMP_OPS_RW_WRITE_UNLOCK,
-	            object);
+	/* Readers do not write so they have no notices to publish */
+	if (isread)
+		mmgrRequest(MMP_OPS_RW_READ_UNLOCK, object);
+	else
+		mmgrRequestNotices(MMP_OPS_RW_WRITE_UNLOCK, object, 0);
 }
 
 /**
@@ -1218,9 +1709,11 @@ mmgrWriteLockHandler(int bid, int cid, Address object, int istry)
 
 #ifdef MMGR_STATS
 	write_lock_reqs++;
+#ifdef MMGR_STATS_PERIOD
 	if (write_locks == MMGR_STATS_PERIOD) {
 		mmgr_print_stats();
 	}
+#endif /* ifdef MMGR_STATS_PERIOD */
 #endif  /* ifdef MMGR_STATS */
 #ifdef VERY_VERBOSE
 	kt_printf(
@@ -1237,16 +1730,16 @@ mmgrWriteLockHandler(int bid, int cid, Address object, int istry)
 		monitor->owner = (bid << 3) | cid;
 
 		/* Send ACK */
-		mmpSend2(bid, cid,
-		         (unsigned int)((monitor->owner << 16) | MMP_OPS_RW_WRITE_ACK),
-		         (unsigned int)object);
+		mmgrGrant(bid, cid,
+		          (unsigned int)((monitor->owner << 16) | MMP_OPS_RW_WRITE_ACK),
+		          monitor);
 #ifdef MMGR_STATS
 		write_locks++;
 #endif  /* MMGR_STATS */
 	}
 	/* Else if is a try lock send a NACK */
 	else if (istry) {
-		mmpSend2(bid, cid,
+		mmpPost2(bid, cid,
 		         (unsigned int)((monitor->owner << 16) | MMP_OPS_RW_WRITE_NACK),
 		         (unsigned int)object);
 
@@ -1285,9 +1778,11 @@ mmgrReadLockHandler(int bid, int cid, Address object, int istry)
 
 #ifdef MMGR_STATS
 	read_lock_reqs++;
+#ifdef MMGR_STATS_PERIOD
 	if (read_locks == MMGR_STATS_PERIOD) {
 		mmgr_print_stats();
 	}
+#endif /* ifdef MMGR_STATS_PERIOD */
 #endif  /* ifdef MMGR_STATS */
 
 #ifdef VERY_VERBOSE
@@ -1306,13 +1801,13 @@ mmgrReadLockHandler(int bid, int cid, Address object, int istry)
 #endif  /* MMGR_STATS */
 
 		/* Reply back with the owner */
-		mmpSend2(bid, cid,
-		         (unsigned int)((monitor->owner << 16) | MMP_OPS_RW_READ_ACK),
-		         (unsigned int)object);
+		mmgrGrant(bid, cid,
+		          (unsigned int)((monitor->owner << 16) | MMP_OPS_RW_READ_ACK),
+		          monitor);
 	}
 	/* Else if is a try lock send a NACK */
 	else if (istry) {
-		mmpSend2(bid, cid,
+		mmpPost2(bid, cid,
 		         (unsigned int)((monitor->owner << 16) | MMP_OPS_RW_READ_NACK),
 		         (unsigned int)object);
 	}
@@ -1329,10 +1824,12 @@ mmgrReadLockHandler(int bid, int cid, Address object, int istry)
  * @param bid    The board id we got the request from
  * @param cid    The core id we got the request from
  * @param object The object on which we were requested to act
- * @param isread Whether it releases a reader or a writer lock
+ * @param isread  Whether it releases a reader or a writer lock
+ * @param notices The releaser's write notices (NULL for readers)
  */
 void
-mmgrRWunlockHandler(int bid, int cid, Address object, int isread)
+mmgrRWunlockHandler(int bid, int cid, Address object, int isread,
+                    unsigned int *notices)
 {
 	monitor_t *monitor;
 	int       id;
@@ -1361,9 +1858,9 @@ mmgrRWunlockHandler(int bid, int cid, Address object, int isread)
 				bid            = id >> 3;
 				cid            = id & 0x7;
 				/* And notify the owner */
-				mmpSend2(bid, cid,
-				         (unsigned int)((id << 16) | MMP_OPS_RW_WRITE_ACK),
-				         (unsigned int)object);
+				mmgrGrant(bid, cid,
+				          (unsigned int)((id << 16) | MMP_OPS_RW_WRITE_ACK),
+				          monitor);
 #ifdef VERY_VERBOSE
 				kt_printf("%p is now owned by %d:%d (%d)\n",
 				          object, monitor->owner >> 3,
@@ -1381,6 +1878,11 @@ mmgrRWunlockHandler(int bid, int cid, Address object, int isread)
 		/* Remove ourself */
 		q_dequeue(&monitor->writers);
 
+		/* Publish the writer's notices to the next acquirers, they
+		 * replace the previous ones (see mmgrMonitorExitHandler) */
+		monitor->notices[0] = notices[0];
+		monitor->notices[1] = notices[1];
+
 		/* If there are pending writer lock requests serve the first one */
 		if ((id = q_peek(&monitor->writers)) != -1) {
 #ifdef MMGR_STATS
@@ -1390,9 +1892,9 @@ mmgrRWunlockHandler(int bid, int cid, Address object, int isread)
 			/* And notify the owner */
 			bid            = id >> 3;
 			cid            = id & 0x7;
-			mmpSend2(bid, cid,
-			         (unsigned int)((id << 16) | MMP_OPS_RW_WRITE_ACK),
-			         (unsigned int)object);
+			mmgrGrant(bid, cid,
+			          (unsigned int)((id << 16) | MMP_OPS_RW_WRITE_ACK),
+			          monitor);
 #ifdef VERY_VERBOSE
 			kt_printf("%p is now owned by %d:%d (%d)\n",
 			          object, monitor->owner >> 3,
@@ -1415,9 +1917,9 @@ mmgrRWunlockHandler(int bid, int cid, Address object, int isread)
 				cid = id & 0x7;
 				monitor->owner++;
 				/* Notify with the owner */
-				mmpSend2(bid, cid,
-				         (unsigned int)((id << 16) | MMP_OPS_RW_READ_ACK),
-				         (unsigned int)object);
+				mmgrGrant(bid, cid,
+				          (unsigned int)((id << 16) | MMP_OPS_RW_READ_ACK),
+				          monitor);
 			}
 		}
 	}
@@ -30,14 +30,65 @@
 
 #include <arch.h>
 #include <address.h>
+#include <topology.h>
 #include "mmp_ops.h"
 
 #define MMGR_HT_SIZE           128
+
+/*
+ * Monitor managers placement, selected with -DMMGR_PLACEMENT=...
+ *
+ * MMGR_PLACE_BOARD  MMGR_MANAGERS managers on the cores of board
+ *                   MMGR_BOARD (or on the ARM boards with
+ *                   -DMMGR_ON_ARM).  This is the default.
+ * MMGR_PLACE_SPREAD Up to MMGR_MANAGERS managers spread over the
+ *                   active cores of the topology (see topology.h),
+ *                   which serve the requests they receive in
+ *                   mmpDrainMailbox.
+ * MMGR_PLACE_HOME   Every active core manages the monitors of the
+ *                   objects in its heap slice (see
+ *                   sysHomeOfAddress).
+ *
+ * In the first two, objects are mapped to managers with a
+ * multiplicative hash of their global address.
+ */
+#define MMGR_PLACE_BOARD  0
+#define MMGR_PLACE_SPREAD 1
+#define MMGR_PLACE_HOME   2
+
+#ifndef MMGR_PLACEMENT
+#define MMGR_PLACEMENT MMGR_PLACE_BOARD
+#endif /* ifndef MMGR_PLACEMENT */
+
+#define MMGR_BOARD  TOPO_RESERVED_BOARD
+
+#ifndef MMGR_MANAGERS
+#if MMGR_PLACEMENT == MMGR_PLACE_BOARD
+#define MMGR_MANAGERS 8
+#else /* MMGR_PLACEMENT == MMGR_PLACE_BOARD */
+#define MMGR_MANAGERS TOPO_MAX_CORES
+#endif /* MMGR_PLACEMENT == MMGR_PLACE_BOARD */
+#endif /* ifndef MMGR_MANAGERS */
+
+/*
+ * Managers running on the VM cores allocate their monitors and
+ * waiters from the last MMGR_ARENA_SIZE bytes of the core's slice,
+ * which are left out of the VM's memory (see sysValloc).  The
+ * managers of board MMGR_BOARD run no VM and use their whole slice.
+ */
+#ifndef MMGR_ARENA_SIZE
+#if MMGR_PLACEMENT == MMGR_PLACE_BOARD
+#define MMGR_ARENA_SIZE 0
+#else /* MMGR_PLACEMENT == MMGR_PLACE_BOARD */
+#define MMGR_ARENA_SIZE 0x100000
+#endif /* MMGR_PLACEMENT == MMGR_PLACE_BOARD */
+#endif /* ifndef MMGR_ARENA_SIZE */
 #define mmgrHT_g               mmgr_g->mmgrHT
 #define mmgrMonitorFreeNodes_g mmgr_g->mmgrMonitorFreeNodes
 #define mmgrWaiterFreeNodes_g  mmgr_g->mmgrWaiterFreeNodes
 #define mmgrAllocTop_g         mmgr_g->mmgrAllocTop
 #define mmgrAllocEnd_g         mmgr_g->mmgrAllocEnd
+#define mmgrRequests_g         mmgr_g->mmgrRequests
 
 typedef struct wait_node waiter_t;
 
@@ -48,6 +99,9 @@ struct wait_node {
 	                  * packed as (board_ID << 3) | (core_ID) */
 	waiter_t *next;  /**< Pointer to the next waiter in the
 	                  * queue */
+#ifdef MMGR_STATS
+	unsigned int since; /**< When it was enqueued (sysGetTicks()) */
+#endif /* ifdef MMGR_STATS */
 };
 
 typedef struct wait_queue wait_queue_t;
@@ -57,6 +111,25 @@ struct wait_queue {
 	waiter_t *tail;
 };
 
+#ifdef MMGR_STATS
+/*
+ * The contention profile histograms have log2 buckets of
+ * sysGetTicks() cycles.  Bucket 0 holds the times up to
+ * 2^MMGR_HIST_SHIFT cycles and bucket i the times in
+ * [2^(MMGR_HIST_SHIFT+i-1), 2^(MMGR_HIST_SHIFT+i)), the last bucket
+ * holds everything above (mmgr_print_stats assumes 12 buckets).
+ */
+#define MMGR_HIST_BUCKETS 12
+#define MMGR_HIST_SHIFT   9
+/* The monitors printed in the contention profile */
+#ifndef MMGR_STATS_TOP
+#define MMGR_STATS_TOP    10
+#endif /* ifndef MMGR_STATS_TOP */
+/* The bytes of the locked object's class name sent with each release
+ * (the spare words of the cache-line message, see mmgrRequestNotices) */
+#define MMGR_NAME_SIZE    44
+#endif /* ifdef MMGR_STATS */
+
 typedef struct monitor monitor_t;
 
 struct monitor {
@@ -78,15 +151,39 @@ struct monitor {
 	monitor_t *rchild;    /**< Pointer to the right child in the
 	                       * Monitor Manager's monitor binary
 	                       * search tree */
+	unsigned int notices[2]; /**< The write notices (boards bitmap)
+	                          * of all the releases of this
+	                          * monitor */
+	int          revoked;    /**< Whether the owner was asked to
+	                          * give back its lease on this
+	                          * monitor */
+	unsigned int tenure;     /**< The number of times this monitor
+	                          * changed owner, so that owners can
+	                          * tell stale revokes */
 #ifdef MMGR_STATS
 	unsigned int times_acquired;  /**< Measuring the times this monitor was acquired */
 	unsigned int times_requested; /**< Measuring the times this monitor was acquired */
+	unsigned int acquired_at;     /**< When it was last granted */
+	unsigned int hold_time;       /**< The total cycles it was held */
+	unsigned int wait_time;       /**< The total cycles requesters
+	                               * waited for it */
+	unsigned int queued;          /**< The current pending requesters */
+	unsigned int max_queued;      /**< The pending requesters' high-water
+	                               * mark */
+	unsigned int hold_hist[MMGR_HIST_BUCKETS]; /**< Hold times histogram */
+	unsigned int wait_hist[MMGR_HIST_BUCKETS]; /**< Wait times histogram */
+	char         name[MMGR_NAME_SIZE + 1];     /**< The locked object's
+	                                            * class name */
 #endif /* ifdef MMGR_STATS */
 };
 
 #ifdef MMGR_STATS
 extern void mmgr_reset_stats();
 extern void mmgr_print_stats();
+extern void mmgrNameMonitor(Address object, const char *name);
+#ifdef ARCH_MB
+extern int  mmgrKlassName(Address object, char *buf, int bufLength);
+#endif /* ARCH_MB */
 #else
 #define mmgr_reset_stats()
 #define mmgr_print_stats()
@@ -98,6 +195,7 @@ typedef struct mmgrGlobalsStruct {
 	waiter_t  *mmgrWaiterFreeNodes;
 	Address   mmgrAllocTop;
 	Address   mmgrAllocEnd;
+	unsigned int mmgrRequests; /**< The requests served (load) */
 } mmgrGlobals
 #ifdef __MICROBLAZE__
 __attribute__((aligned(MM_CACHELINE_SIZE)))
@@ -105,28 +203,36 @@ __attribute__((aligned(MM_CACHELINE_SIZE)))
 ;
 
 void mmgrInitialize(mmgrGlobals *globals);
+int  mmgrManagerCount();
+void mmgrManagerOf(int index, int *bid, int *cid);
+int  mmgrGetManagerIndex(Address object);
 
 #ifdef ARCH_MB
-void mmgrRequestHash(mmpMsgOp_t msg_op, unsigned int hash);
+void mmgrRequest(mmpMsgOp_t msg_op, Address object);
 void mmgrMonitorEnter(Address object);
 void mmgrMonitorExit(Address object);
 void mmgrWaitMonitorExit(Address object);
 void mmgrAddWaiter(Address object);
 void mmgrRemoveWaiter(Address object);
 void mmgrNotify(Address object, int all);
+void mmgrHandoff(Address object, int successor, unsigned int tenure);
 
 #endif /* ARCH_MB */
 void mmgrMonitorEnterHandler(int bid, int cid, Address object);
-void mmgrMonitorExitHandler(int bid, int cid, Address object, int iswait);
+void mmgrMonitorExitHandler(int bid, int cid, Address object, int iswait,
+                            unsigned int *notices);
 void mmgrRemoveWaiterHandler(int bid, int cid, Address object);
 void mmgrAddWaiterHandler(int bid, int cid, Address object);
 void mmgrNotifyHandler(int bid, int cid, Address object, int all);
+void mmgrHandoffHandler(int bid, int cid, Address object, int successor,
+                        unsigned int *notices);
 
 void mmgrWriteLock(Address object, int istry);
 void mmgrRWunlock(Address object, int istry);
 void mmgrReadLock(Address object, int isread);
 void mmgrWriteLockHandler(int bid, int cid, Address object, int istry);
 void mmgrReadLockHandler(int bid, int cid, Address object, int istry);
-void mmgrRWunlockHandler(int bid, int cid, Address object, int isread);
+void mmgrRWunlockHandler(int bid, int cid, Address object, int isread,
+                         unsigned int *notices);
 
 #endif /* MMGR_H_ */
@@ -33,22 +33,43 @@
 #include "mmp.h"
 #include "mmgr.h"
 #include "apmgr.h"
+#include "globals.h"
+
+#ifdef MMP_STATS
+void mmp_reset_stats() {
+	int i;
+
+	for (i = 0; i < MMP_STATS_COUNT; ++i) {
+		mmpStats_g[i] = 0;
+	}
+}
+
+void mmp_print_stats() {
+	kt_printf("MMP_STATS | %2d:%1d | %u/%u | %u/%u | %u | %u/%u |\n",
+	          sysGetIsland(), sysGetCore(),
+	          mmpStats_g[MMP_STATS_SENDS], mmpStats_g[MMP_STATS_SEND_TICKS],
+	          mmpStats_g[MMP_STATS_POSTS], mmpStats_g[MMP_STATS_POST_TICKS],
+	          mmpStats_g[MMP_STATS_NACKS],
+	          mmpStats_g[MMP_STATS_FENCES], mmpStats_g[MMP_STATS_FENCE_TICKS]);
+
+	mmp_reset_stats();
+}
+#endif  /* MMP_STATS */
 
 /**
- * Peeks a core to schedule the given thread.  Then sends a message to
- * this core with the thread object's address and the core and island
- * of the hardware thread that spawned it.  The other end (receiving
- * thread) will add this thread to it's thread queue and implicitly
- * fetch it when needed (lazely).
+ * Sends a message to the given core with the thread object's address
+ * and the core and island of the hardware thread that spawned it.
+ * The other end (receiving thread) will add this thread to it's thread
+ * queue and implicitly fetch it when needed (lazely).
  *
- * @param thread The thread object's address
+ * @param thread     The thread object's address
+ * @param target_bid The board to run the thread
+ * @param target_cid The core to run the thread
  */
-void
-mmpSpawnThread(Address thread)
+static inline void
+mmpSpawnThreadTo(Address thread, int target_bid, int target_cid)
 {
 	unsigned int msg0;
-	int          target_cid;
-	int          target_bid;
 
 	/*
 	 * Pass your bid and cid with the opcode so that the other end
@@ -56,70 +77,513 @@ mmpSpawnThread(Address thread)
 	 * the global address but for consistency with all the messages we
 	 * provide it as well.
 	 */
-	msg0 = (sysGetIsland() << 19) | (sysGetCore() << 16) | MMP_OPS_TH_SPAWN;
+	msg0 = MMP_REQUEST(MMP_OPS_TH_SPAWN);
+
+	/* Write back all dirty data (this is a release action) */
+	sc_flush(SC_BLOCKING);
+
+	mmpPost2(target_bid, target_cid, msg0, (unsigned int)thread);
+}
+
+/**
+ * Peeks a core to schedule the given thread and spawns it there.
+ *
+ * @param thread The thread object's address
+ */
+void
+mmpSpawnThread(Address thread)
+{
+	int target_cid;
+	int target_bid;
 
 	schdlrNext(&target_bid, &target_cid);
+	mmpSpawnThreadTo(thread, target_bid, target_cid);
+}
+
+/**
+ * Spawns the given thread on the given core or, if it is -1, near the
+ * home of the given object (see Thread.setPreferredCore and
+ * Thread.setNear).  Objects out of the heap (e.g. in ROM) have no
+ * home, so their threads are placed as by mmpSpawnThread.
+ *
+ * @param thread The thread object's address
+ * @param core   The core to run the thread packed as
+ *               (board_ID << 3) | (core_ID), or -1
+ * @param near   The object to run the thread near, or NULL
+ */
+void
+mmpSpawnThreadNear(Address thread, int core, Address near)
+{
+	int target_cid;
+	int target_bid;
+	int board = 0;
+
+	if (core < 0 && near != NULL) {
+		sysHomeOfAddress(near, &target_bid, &target_cid);
+		if (target_bid)
+			core = ((target_bid - 1) << 3) | target_cid;
+#if SCHDLR_NEAR_BOARD
+		board = 1;
+#endif /* if SCHDLR_NEAR_BOARD */
+	}
+
+	schdlrNear(core, board, &target_bid, &target_cid);
+	mmpSpawnThreadTo(thread, target_bid, target_cid);
+}
+
+/**
+ * Hands the threads [from, to) of the given array down a spawn tree.
+ * We send the upper half of the range to a core, then the upper half
+ * of what is left to another, and so on, down to a single thread.
+ * Each core receiving a part starts its first thread and hands the
+ * rest on the same way (see mmpReceive), so that the threads are
+ * spawned in a logarithmic number of steps.
+ *
+ * @param threads The array of the threads
+ * @param from    The index of the first thread to spawn
+ * @param to      The index after the last thread to spawn
+ */
+static void
+mmpSpawnRange(Address threads, int from, int to)
+{
+	unsigned int msg[16] __attribute__ ((aligned(MM_CACHELINE_SIZE)));
+	int          mid;
+	int          target_cid;
+	int          target_bid;
+
+	msg[0] = MMP_REQUEST(MMP_OPS_TH_SPAWN_TREE);
+	msg[1] = (unsigned int)threads;
+	kt_memset(&msg[4], 0, 12 * sizeof(unsigned int));
+
+	while (from < to) {
+		mid = (from + to) >> 1;
+
+		msg[2] = mid;
+		msg[3] = to;
+
+		schdlrNext(&target_bid, &target_cid);
+		mmpPost16(target_bid, target_cid, msg);
+
+		to = mid;
+	}
+}
+
+/**
+ * Spawns all the threads of the given array through a spawn tree (see
+ * mmpSpawnRange).  The spawned threads are never touched by the cores
+ * forwarding them, so a single write back here publishes them all.
+ *
+ * @param threads The array of the threads, which no core has cached
+ * @param count   The number of threads
+ */
+void
+mmpSpawnAll(Address threads, int count)
+{
+	if (count == 0)
+		return;
+
 	/* Write back all dirty data (this is a release action) */
 	sc_flush(SC_BLOCKING);
 
-	mmpSend2(target_bid, target_cid, msg0, (unsigned int)thread);
+	mmpSpawnRange(threads, 0, count);
+}
+
+/**
+ * Ask a busy core for one of its not yet started threads (see
+ * VMThread.rescheduleNext).  It replies with a MMP_OPS_TH_STEAL_R
+ * carrying the thread or a MMP_OPS_TH_STEAL_NACK.
+ */
+void
+mmpSteal()
+{
+	int target_cid;
+	int target_bid;
+
+	schdlrVictim(&target_bid, &target_cid);
+
+	mmpPost(target_bid, target_cid, MMP_REQUEST(MMP_OPS_TH_STEAL));
 }
 
 /**
- * Query the mailbox for incoming messages and return a thread object
- * if one of the messages was about scheduling a thread to this core.
+ * Reply to a steal request, handing over the given not yet started
+ * thread.  The thread object is clean in our cache, since we never
+ * touched it, and up to date in main memory, since its spawner wrote
+ * it back before spawning it.  We just drop our copy.
  *
- * @return a thread object if one of the messages was about scheduling
- *         a thread to this core or NULL otherwise
+ * @param thief  The thief's id packed as (board_ID << 3) | (core_ID)
+ * @param thread The thread object's address or NULL to refuse
  */
-Address
-mmpCheckMailbox(Address type, Address hash)
+void
+mmpStealReply(int thief, Address thread)
+{
+	if (thread == NULL) {
+		mmpPost(thief >> 3, thief & 0x7, MMP_REQUEST(MMP_OPS_TH_STEAL_NACK));
+
+		return;
+	}
+
+	sc_invalidate_object(thread);
+	mmpPost2(thief >> 3, thief & 0x7, MMP_REQUEST(MMP_OPS_TH_STEAL_R),
+	         (unsigned int)thread);
+}
+
+#ifndef MMP_BLOCKING
+/**
+ * Hands the given pending message to the NI, keeping track of its
+ * ack with the slot's counter.
+ *
+ * @param p The pending message
+ */
+static inline void
+mmpIssue(mmp_pending_st *p)
+{
+	/* Wait until our DMA engine can support at least one more DMA */
+	while (!(ar_ni_status_get(my_cid) & 0xFF)) {
+		;
+	}
+
+	ar_cnt_set(sysGetCore(), p->cnt, -4 * p->size);
+
+	switch (p->size) {
+	case 1:
+		ar_mbox_send_ack(sysGetCore(), p->bid, p->cid,
+		                 sysGetIsland(), sysGetCore(), p->cnt, p->msg[0]);
+		break;
+	case 2:
+		ar_mbox_send2_ack(sysGetCore(), p->bid, p->cid,
+		                  sysGetIsland(), sysGetCore(), p->cnt,
+		                  p->msg[0], p->msg[1]);
+		break;
+	default:
+		ar_dma_with_ack(sysGetCore(), sysGetIsland(), sysGetCore(),
+		                (unsigned int)p->msg,
+		                p->bid, p->cid, ar_addr_of_mbox(p->bid, p->cid),
+		                sysGetIsland(), sysGetCore(), p->cnt,
+		                64, 0, 0, 0);
+		break;
+	}
+}
+
+/**
+ * Returns the bitmap of the slots with messages in flight to the
+ * given core.
+ *
+ * @param to_bid The target core's board ID
+ * @param to_cid The target core's core ID
+ */
+static inline unsigned int
+mmpPendingTo(int to_bid, int to_cid)
+{
+	unsigned int used, to;
+	int          i;
+
+	to   = 0;
+	used = mmpPendingUsed_g;
+
+	while (used) {
+		i     = __builtin_ctz(used);
+		used &= used - 1;
+
+		if (mmpPending_g[i].bid == to_bid && mmpPending_g[i].cid == to_cid)
+			to |= 1U << i;
+	}
+
+	return to;
+}
+
+/**
+ * Posts a size-word mailbox message to the given core.  Only one
+ * message per destination is kept in flight, so that a Nacked message
+ * is never overtaken by the next one to the same core.
+ *
+ * @param to_bid The target core's board ID
+ * @param to_cid The target core's core ID
+ * @param size   The message's size in words (1, 2 or 16)
+ * @param msg    The message
+ */
+static void
+mmpPostMsg(int to_bid, int to_cid, int size, unsigned int *msg)
+{
+	mmp_pending_st *p;
+	int             i;
+#ifdef MMP_STATS
+	unsigned int    start = sysGetTicks();
+#endif /* ifdef MMP_STATS */
+
+	/* Wait for the previous message to the same core */
+	while (mmpPendingTo(to_bid, to_cid)) {
+		mmpPoll();
+	}
+
+	/* Wait for a free slot */
+	while (mmpPendingUsed_g == (1U << MMP_PENDING_SLOTS) - 1) {
+		mmpPoll();
+	}
+
+	i = __builtin_ctz(~mmpPendingUsed_g);
+	p = &mmpPending_g[i];
+
+	kt_memcpy(p->msg, msg, size * sizeof(unsigned int));
+	p->size = size;
+	p->bid  = to_bid;
+	p->cid  = to_cid;
+	p->cnt  = hwcnt_get_free(HWCNT_MMP_ASYNC);
+
+	mmpPendingUsed_g |= 1U << i;
+	mmpIssue(p);
+
+#ifdef MMP_STATS
+	mmpStats_g[MMP_STATS_POSTS]++;
+	mmpStats_g[MMP_STATS_POST_TICKS] += sysGetTicks() - start;
+#endif /* ifdef MMP_STATS */
+}
+#endif /* ifndef MMP_BLOCKING */
+
+/**
+ * Post a single word mailbox message to the given core.
+ *
+ * @param to_bid The target core's board ID
+ * @param to_cid The target core's core ID
+ * @param msg    The word to send
+ */
+void
+mmpPost(int to_bid, int to_cid, unsigned int msg)
+{
+#ifdef MMP_BLOCKING
+	mmpSend(to_bid, to_cid, msg);
+#else /* ifdef MMP_BLOCKING */
+	mmpPostMsg(to_bid, to_cid, 1, &msg);
+#endif /* ifdef MMP_BLOCKING */
+}
+
+/**
+ * Post a 2-word mailbox message to the given core.
+ *
+ * @param to_bid The target core's board ID
+ * @param to_cid The target core's core ID
+ * @param msg0   The first word to send
+ * @param msg1   The second word to send
+ */
+void
+mmpPost2(int to_bid, int to_cid, unsigned int msg0, unsigned int msg1)
+{
+#ifdef MMP_BLOCKING
+	mmpSend2(to_bid, to_cid, msg0, msg1);
+#else /* ifdef MMP_BLOCKING */
+	unsigned int msg[2];
+
+	msg[0] = msg0;
+	msg[1] = msg1;
+	mmpPostMsg(to_bid, to_cid, 2, msg);
+#endif /* ifdef MMP_BLOCKING */
+}
+
+/**
+ * Post a 16-word mailbox message to the given core.  The message is
+ * copied, the caller may reuse it on return.
+ *
+ * @param to_bid The target core's board ID
+ * @param to_cid The target core's core ID
+ * @param msg    A 64-byte array containing the whole message to send
+ */
+void
+mmpPost16(int to_bid, int to_cid, unsigned int msg[16])
+{
+#ifdef MMP_BLOCKING
+	mmpSend16(to_bid, to_cid, msg);
+#else /* ifdef MMP_BLOCKING */
+	mmpPostMsg(to_bid, to_cid, 16, msg);
+#endif /* ifdef MMP_BLOCKING */
+}
+
+/**
+ * Reconcile the acks of the posted messages.  Acked messages free
+ * their slot and Nacked ones are re-sent.  Never blocks.
+ */
+void
+mmpPoll()
+{
+#ifndef MMP_BLOCKING
+	mmp_pending_st *p;
+	unsigned int    used;
+	int             i, ret;
+
+	used = mmpPendingUsed_g;
+
+	while (used) {
+		i     = __builtin_ctz(used);
+		used &= used - 1;
+		p     = &mmpPending_g[i];
+		ret   = ar_cnt_get_triggered(sysGetCore(), p->cnt);
+
+		/* Still in flight */
+		if (ret == 0)
+			continue;
+
+		/* Retry on Nack */
+		if (ret == 3) {
+#ifdef PRINT_NACKS
+			printf("mmpPost Nacked\n");
+#endif  /* ifdef PRINT_NACKS */
+#ifdef MMP_STATS
+			mmpStats_g[MMP_STATS_NACKS]++;
+#endif /* ifdef MMP_STATS */
+			mmpIssue(p);
+			continue;
+		}
+
+		assume(ret == 2); /* Ack */
+		assume(ar_cnt_get(sysGetCore(), p->cnt) == 0);
+		hwcnt_release(p->cnt);
+		mmpPendingUsed_g &= ~(1U << i);
+	}
+#endif /* ifndef MMP_BLOCKING */
+}
+
+/**
+ * Wait until all the messages we posted to the given core are
+ * delivered.
+ *
+ * @param to_bid The target core's board ID
+ * @param to_cid The target core's core ID
+ */
+void
+mmpFenceTo(int to_bid, int to_cid)
+{
+#ifndef MMP_BLOCKING
+	unsigned int to;
+#ifdef MMP_STATS
+	unsigned int start = sysGetTicks();
+#endif /* ifdef MMP_STATS */
+
+	to = mmpPendingTo(to_bid, to_cid);
+
+	while (to & mmpPendingUsed_g) {
+		mmpPoll();
+	}
+
+#ifdef MMP_STATS
+	mmpStats_g[MMP_STATS_FENCES]++;
+	mmpStats_g[MMP_STATS_FENCE_TICKS] += sysGetTicks() - start;
+#endif /* ifdef MMP_STATS */
+#endif /* ifndef MMP_BLOCKING */
+}
+
+/**
+ * Wait until all the messages we posted are delivered.
+ */
+void
+mmpFence()
+{
+#ifndef MMP_BLOCKING
+#ifdef MMP_STATS
+	unsigned int start = sysGetTicks();
+#endif /* ifdef MMP_STATS */
+
+	while (mmpPendingUsed_g) {
+		mmpPoll();
+	}
+
+#ifdef MMP_STATS
+	mmpStats_g[MMP_STATS_FENCES]++;
+	mmpStats_g[MMP_STATS_FENCE_TICKS] += sysGetTicks() - start;
+#endif /* ifdef MMP_STATS */
+#endif /* ifndef MMP_BLOCKING */
+}
+
+#ifdef MMGR_STATS
+/* The class name carried by the last release, see mmpGetNotices */
+static unsigned int mmpName[11];
+#endif /* ifdef MMGR_STATS */
+
+/**
+ * Pops the write notices, the extra argument and the remaining empty
+ * words of a cache-line message carrying them (see mmgrGrant and
+ * mmgrRequestNotices).
+ *
+ * With MMGR_STATS the remaining words of the releases carry the
+ * releaser's class name for the object, which we keep in mmpName.
+ *
+ * @param notices Where to store the write notices (return)
+ * @param arg     Where to store the extra argument (return) or NULL
+ */
+static inline void
+mmpGetNotices(unsigned int *notices, unsigned int *arg)
+{
+	int          i;
+	unsigned int word;
+
+	notices[0] = ar_mbox_get(sysGetCore());
+	notices[1] = ar_mbox_get(sysGetCore());
+	word       = ar_mbox_get(sysGetCore());
+
+	if (arg != NULL)
+		*arg = word;
+
+	/* pop the empty words... */
+	for (i = 0; i < 11; ++i) {
+#ifdef MMGR_STATS
+		mmpName[i] = ar_mbox_get(sysGetCore());
+#else /* ifdef MMGR_STATS */
+		(void)ar_mbox_get(sysGetCore());
+#endif /* ifdef MMGR_STATS */
+	}
+}
+
+/**
+ * Pop the first message from the mailbox and handle it.  Requests to
+ * us (e.g. as a monitor or atomic primitives manager) are served
+ * right away.
+ *
+ * @param op   The message type, or MMP_OPS_NOP if the message needs
+ *             no further handling (return)
+ * @param args The tenure and successor of monitor ACKs and revokes
+ *             or the thief of steal requests (return)
+ *
+ * @return the thread, object or requesting thread the message is
+ *         about if the scheduler needs to handle it, NULL otherwise
+ */
+static inline Address
+mmpReceive(mmpMsgOp_t *op, unsigned int *args)
 {
 	unsigned int msg0;
 	int          bid;
 	int          cid;
 	int          tmp;
-	int          new, expected, i;
+#ifndef ARCH_ARM
+	int                i;
+	int                flags;
+	unsigned long long arg0, arg1;
+#endif /* ARCH_ARM */
+	unsigned int notices[2];
 	mmpMsgOp_t   msg_type;
 	Address      result;
 	Address      object;
-
-#ifdef VERY_VERBOSE
-	if (sysGetCore() == 0 && sysGetIsland() == 0) {
-		kt_printf("IN mmpCheckMailbox\n");
-		ar_uart_flush();
-	}
-#endif /* ifdef VERY_VERBOSE */
-
-	/* First check to see if there are any messages (non blocking) */
-	if ((ar_mbox_status_get(sysGetCore()) & 0xFFFF) == 0) {
-		/* Set message type (OP) to NOP */
-		if (type != NULL)
-			set_java_lang_Integer_value(type, MMP_OPS_NOP);
-
-		return NULL;
-	}
+	int          event;
 
 	result = NULL;
+	event  = 0;
 	tmp    = 0;
 
 	/* If there are, get the first */
 	msg0     = ar_mbox_get(sysGetCore());
-	msg_type = (mmpMsgOp_t)(msg0 & 0xFFFF);
+	msg_type = (mmpMsgOp_t)(msg0 & MMP_OPS_MASK);
 	cid      = (msg0 >> 16) & 0x7;
 	bid      = (msg0 >> 19) & 0x3F;
 
+#ifndef ARCH_ARM
+	/* Keep the load piggybacked on requests (see schdlrNext) */
+	if (msg0 & MMP_LOAD_VALID)
+		schdlrSawLoad(bid, cid, (msg0 >> MMP_LOAD_SHIFT) & MMP_LOAD_MASK);
+#endif /* ARCH_ARM */
+
 #ifdef VERY_VERBOSE
 	if (sysGetCore() == 0 && sysGetIsland() == 0) {
-		kt_printf("IN mmpCheckMailbox msg_type=%d\n", msg_type);
+		kt_printf("IN mmpReceive msg_type=%d\n", msg_type);
 		ar_uart_flush();
 	}
 #endif /* ifdef VERY_VERBOSE */
 
-	/* Set message type (OP) */
-	if (type != NULL)
-		set_java_lang_Integer_value(type, msg_type);
-
 	switch (msg_type) {
 #ifndef ARCH_ARM
 	/* Thread specific messages */
@@ -142,15 +606,68 @@ mmpCheckMailbox(Address type, Address hash)
 		/* kt_printf("Our new thread %p is in cache\n", object);
 		 * kt_printf("The time is %u\n", ar_free_timer_get_ticks()); */
 		result = object;
+		/* Tell the spawner our load, counting the new thread */
+		schedulerLoad_g++;
+		mmpPost(bid, cid, MMP_REQUEST(MMP_OPS_SCHED_LOAD));
+		break;
+	case MMP_OPS_TH_SPAWN_TREE:
+		/*
+		 * this is a cache-line message.  The second word holds the
+		 * address of an array of threads followed by the range
+		 * [from, to) of it to spawn.  The array and the threads are
+		 * fetched from main memory when needed, the spawner wrote
+		 * them back.
+		 */
+		object  = (Address)ar_mbox_get(sysGetCore());
+		args[0] = ar_mbox_get(sysGetCore());
+		tmp     = ar_mbox_get(sysGetCore());
+		/* pop the empty words... */
+		for (i = 0; i < 12; ++i) {
+			(void)ar_mbox_get(sysGetCore());
+		}
+		assume(object != NULL);
+		/* Hand the rest on first, so that the subtrees start spawning */
+		mmpSpawnRange(object, args[0] + 1, tmp);
+		/* The scheduler starts the first one */
+		result = object;
+		/* Tell the spawner our load, counting the new thread */
+		schedulerLoad_g++;
+		mmpPost(bid, cid, MMP_REQUEST(MMP_OPS_SCHED_LOAD));
+		break;
+	case MMP_OPS_SCHED_LOAD:
+		/* this is a single word message, its load is already kept */
+		break;
+	case MMP_OPS_TH_STEAL:
+		/* this is a single word message, the scheduler replies */
+		args[1] = (bid << 3) | cid;
+		event   = 1;
+		break;
+	case MMP_OPS_TH_STEAL_R:
+		/*
+		 * this is a two-words message.  Fetch the thread from main
+		 * memory, the victim never wrote it.
+		 */
+		object = (Address)ar_mbox_get(sysGetCore());
+		assume(object != NULL);
+		sc_put(object, -1);
+		result = object;
+		break;
+	case MMP_OPS_TH_STEAL_NACK:
+		/* this is a single word message */
+		event = 1;
 		break;
 	/* Handle Monitor Manager replies */
 	case MMP_OPS_MNTR_ACK:
 		/*
-		 * The second word holds the hash of the object for which we
-		 * requested the monitor
+		 * this is a cache-line message.  The second word holds the
+		 * address of the object for which we requested the monitor
+		 * followed by the write notices of its last release and our
+		 * tenure.  It might come from the manager or, on handoffs,
+		 * straight from the previous owner.
 		 */
 		object = (Address)ar_mbox_get(sysGetCore());
-		/* kt_printf("IN mmpCheckMailbox object=%p\n", object);
+		mmpGetNotices(notices, &args[0]);
+		/* kt_printf("IN mmpReceive object=%p\n", object);
 		 * ar_uart_flush(); */
 
 #  ifdef MMGR_QUEUE
@@ -163,6 +680,7 @@ mmpCheckMailbox(Address type, Address hash)
 		ar_uart_flush();
 #    endif /* ifdef VERY_VERBOSE */
 
+		sc_invalidate(notices);
 		result = object;
 
 #  else /* ifdef MMGR_QUEUE */
@@ -178,8 +696,7 @@ mmpCheckMailbox(Address type, Address hash)
 			   (due to underlying hardware limitations) */
 			/* Resend the enter request.  We do not use the mmgrMonitorEnter
 			 * here to speed up things */
-			mmgrRequestHash(MMP_OPS_MNTR_ENTER, (unsigned int)object);
-			set_java_lang_Integer_value(type, MMP_OPS_NOP);
+			mmgrRequest(MMP_OPS_MNTR_ENTER, object);
 		}
 		else {
 #    ifdef VERY_VERBOSE
@@ -187,6 +704,7 @@ mmpCheckMailbox(Address type, Address hash)
 			ar_uart_flush();
 #    endif /* ifdef VERY_VERBOSE */
 
+			sc_invalidate(notices);
 			result = object;
 		}
 
@@ -198,6 +716,16 @@ mmpCheckMailbox(Address type, Address hash)
 		/* this is a two-words message */
 		result = (Address)ar_mbox_get(sysGetCore());
 		break;
+	case MMP_OPS_MNTR_REVOKE:
+		/*
+		 * this is a cache-line message.  The address is followed by the
+		 * tenure it revokes and the next owner (see mmgrRevoke).
+		 */
+		result = (Address)ar_mbox_get(sysGetCore());
+		mmpGetNotices(notices, NULL);
+		args[0] = notices[0];
+		args[1] = notices[1];
+		break;
 #endif /* ARCH_ARM */
 	/* Monitor specific messages */
 	case MMP_OPS_MNTR_ENTER:
@@ -237,11 +765,22 @@ mmpCheckMailbox(Address type, Address hash)
 		object = (Address)ar_mbox_get(sysGetCore());
 		mmgrNotifyHandler(bid, cid, object, tmp);
 		break;
+	case MMP_OPS_MNTR_HANDOFF:
+		/* this is a cache-line message */
+		object = (Address)ar_mbox_get(sysGetCore());
+		mmpGetNotices(notices, (unsigned int*)&tmp);
+		assume(object != NULL);
+#ifdef MMGR_STATS
+		mmgrNameMonitor(object, (char*)mmpName);
+#endif /* ifdef MMGR_STATS */
+		mmgrHandoffHandler(bid, cid, object, tmp, notices);
+		break;
 	case MMP_OPS_MNTR_WAIT:
 		tmp = 1;   /* Don't break here */
 	case MMP_OPS_MNTR_EXIT:
-		/* this is a two-words message */
+		/* this is a cache-line message */
 		object = (Address)ar_mbox_get(sysGetCore());
+		mmpGetNotices(notices, NULL);
 		/* if (/\* sysGetCore() == 0 && *\/ sysGetIsland() == 63) {
 		 * 	kt_printf("IN MNTR_EXIT object=%p queue_len=%d from=%d:%d\n",
 		 * 	          object, ar_mbox_status_get(sysGetCore()) & 0xFFFF,
@@ -251,23 +790,44 @@ mmpCheckMailbox(Address type, Address hash)
 		/* kt_printf("0x%02X/%d wants to exit monitor (%p)\n",
 		 *           from_bid, from_cid, object); */
 		assume(object != NULL);
-		mmgrMonitorExitHandler(bid, cid, object, tmp);
+#ifdef MMGR_STATS
+		mmgrNameMonitor(object, (char*)mmpName);
+#endif /* ifdef MMGR_STATS */
+		mmgrMonitorExitHandler(bid, cid, object, tmp, notices);
 		break;
+#ifndef ARCH_ARM
 	/* Handle atomic primitives */
 	case MMP_OPS_AT_CAS:
+	case MMP_OPS_AT_FAD:
+	case MMP_OPS_AT_SWAP:
+	case MMP_OPS_AT_SET:
+	case MMP_OPS_AT_GET:
 		/* this is a cache-line message */
-		object   = (Address)ar_mbox_get(sysGetCore());
+		object = (Address)ar_mbox_get(sysGetCore());
 		assume(object != NULL);
-		expected = (int)ar_mbox_get(sysGetCore());
-		new      = (int)ar_mbox_get(sysGetCore());
+		tmp    = (int)ar_mbox_get(sysGetCore());
+		result = (Address)ar_mbox_get(sysGetCore());
+		arg0   = ar_mbox_get(sysGetCore());
+		arg0  |= (unsigned long long)ar_mbox_get(sysGetCore()) << 32;
+		arg1   = ar_mbox_get(sysGetCore());
+		arg1  |= (unsigned long long)ar_mbox_get(sysGetCore()) << 32;
+		flags  = (int)ar_mbox_get(sysGetCore());
+
+		for (i = 0; i < SC_NOTICE_WORDS; ++i) {
+			notices[i] = ar_mbox_get(sysGetCore());
+		}
 
 		/* pop the empty words... */
-		for (i = 0; i < 12; ++i) {
+		for (i = 0; i < 7 - SC_NOTICE_WORDS; ++i) {
 			(void)ar_mbox_get(sysGetCore());
 		}
 
-		apmgrCASHandler(bid, cid, object, expected, new);
+		apmgrHandler(bid, cid, msg_type, object, tmp, arg0, arg1, flags,
+		             result, notices);
+		/* The requester is not ours, we only served it */
+		result = NULL;
 		break;
+#endif /* ARCH_ARM */
 	/* TODO: Add Christi's op-codes here */
 	/*
 	 * Hash-Table
@@ -292,23 +852,53 @@ mmpCheckMailbox(Address type, Address hash)
 		mmgrWriteLockHandler(bid, cid, object, tmp);
 		break;
 	case MMP_OPS_RW_READ_UNLOCK:
-		tmp = 1;   /* Don't break here */
-	case MMP_OPS_RW_WRITE_UNLOCK:
 		/* this is a two-words message */
 		object = (Address)ar_mbox_get(sysGetCore());
 		ar_assert(object != NULL);
-		mmgrRWunlockHandler(bid, cid, object, tmp);
+		mmgrRWunlockHandler(bid, cid, object, 1, NULL);
 		break;
+	case MMP_OPS_RW_WRITE_UNLOCK:
+		/* this is a cache-line message */
+		object = (Address)ar_mbox_get(sysGetCore());
+		ar_assert(object != NULL);
+		mmpGetNotices(notices, NULL);
+		mmgrRWunlockHandler(bid, cid, object, 0, notices);
+		break;
+#ifndef ARCH_ARM
 	case MMP_OPS_RW_READ_ACK:
 	case MMP_OPS_RW_WRITE_ACK:
-		/* /\* Empty our software cache.  There is no need to for writing back any
-		 *  * dirty
-		 *  * data, since they should be the result of a data race *\/
-		 * /\* sc_flush(); *\/
-		 * sc_clear(); */
+		/* this is a cache-line message */
+		result = (Address)ar_mbox_get(sysGetCore());
+		assume(result != NULL);
+		mmpGetNotices(notices, NULL);
+		/* Invalidate the objects that might be stale */
+		sc_invalidate(notices);
+		break;
 	case MMP_OPS_AT_CAS_ACK:
-		/* For CAS we clear the cache at request */
 	case MMP_OPS_AT_CAS_NACK:
+	case MMP_OPS_AT_FAD_R:
+	case MMP_OPS_AT_SWAP_R:
+	case MMP_OPS_AT_SET_R:
+	case MMP_OPS_AT_GET_R:
+		/* this is a cache-line message */
+		object = (Address)ar_mbox_get(sysGetCore());
+		result = (Address)ar_mbox_get(sysGetCore());
+		assume(result != NULL);
+		arg0   = ar_mbox_get(sysGetCore());
+		arg0  |= (unsigned long long)ar_mbox_get(sysGetCore()) << 32;
+
+		for (i = 0; i < SC_NOTICE_WORDS; ++i) {
+			notices[i] = ar_mbox_get(sysGetCore());
+		}
+
+		/* pop the empty words... */
+		for (i = 0; i < 11 - SC_NOTICE_WORDS; ++i) {
+			(void)ar_mbox_get(sysGetCore());
+		}
+
+		apmgrReplyHandler(object, result, arg0, notices);
+		break;
+#endif /* ARCH_ARM */
 	case MMP_OPS_RW_READ_NACK:
 	case MMP_OPS_RW_WRITE_NACK:
 		result = (Address)ar_mbox_get(sysGetCore());
@@ -316,9 +906,11 @@ mmpCheckMailbox(Address type, Address hash)
 		break;
 	case MMP_OPS_MMGR_RESET_STATS:
 		mmgr_reset_stats();
+		mmp_reset_stats();
 		break;
 	case MMP_OPS_MMGR_PRINT_STATS:
 		mmgr_print_stats();
+		mmp_print_stats();
 		break;
 	default:
 		kt_printf("Error: Unknown message operator\n");
@@ -327,8 +919,93 @@ mmpCheckMailbox(Address type, Address hash)
 		break;
 	}              /* switch */
 
-	if (hash != NULL)
-		set_java_lang_Integer_value(hash, (int)result);
+	/*
+	 * Requests we served (e.g. as a monitor manager) need no further
+	 * handling by the caller
+	 */
+	*op = (result == NULL && !event) ? MMP_OPS_NOP : msg_type;
 
 	return result;
+}                  /* mmpReceive */
+
+/**
+ * Drain the mailbox in one go.  The requests to us are served here
+ * and only the events the scheduler has to handle (thread spawns and
+ * steals, monitor grants, revokes and notifications, RW-lock and
+ * atomic primitive replies) are stored in the given batch, MMP_BATCH_ENTRY
+ * words each (see VMThread.rescheduleNext).
+ *
+ * At most MMP_DRAIN_MAX messages are popped per call, so that busy
+ * managers still run their own threads, and none once the batch is
+ * full.  The managers on the ARM cores pass no batch, they get no
+ * events.
+ *
+ * @param batch  The int array to store the events in, or NULL
+ * @param length The batch's length in words
+ * @param load   Our runnable threads (see schdlrSetLoad)
+ *
+ * @return the number of words stored in the batch
+ */
+int
+mmpDrainMailbox(Address batch, int length, int load)
+{
+	unsigned int args[2];
+	mmpMsgOp_t   op;
+	Address      result;
+	int          i, n;
+
+	/* Reconcile the acks of the messages we posted */
+	mmpPoll();
+
+#ifndef ARCH_ARM
+	schdlrSetLoad(load);
+
+	/* Make some progress on the software cache prefetches */
+	sc_prefetch_progress();
+#endif /* ARCH_ARM */
+
+	n = 0;
+
+	for (i = 0; i < MMP_DRAIN_MAX; ++i) {
+		if (batch != NULL && n + MMP_BATCH_ENTRY > length)
+			break;
+
+		/* Check to see if there are any messages (non blocking) */
+		if ((ar_mbox_status_get(sysGetCore()) & 0xFFFF) == 0)
+			break;
+
+		args[0] = 0;
+		args[1] = 0;
+		result  = mmpReceive(&op, args);
+
+		if (op == MMP_OPS_NOP)
+			continue;
+
+		assume(batch != NULL);
+		setInt(batch, n + MMP_BATCH_OP, op);
+		setInt(batch, n + MMP_BATCH_KEY, (int)result);
+		setInt(batch, n + MMP_BATCH_TENURE, args[0]);
+		setInt(batch, n + MMP_BATCH_SUCCESSOR, args[1]);
+		n += MMP_BATCH_ENTRY;
+	}
+
+	return n;
+}                  /* mmpDrainMailbox */
+
+/**
+ * Query the mailbox for incoming messages and serve the requests to
+ * us, for the callers that get no events, e.g., the managers' loop in
+ * myrmics' java_main.  See mmpDrainMailbox.
+ *
+ * @param type Unused
+ * @param key  Unused
+ *
+ * @return NULL, no events are returned
+ */
+Address
+mmpCheckMailbox(Address type, Address key)
+{
+	mmpDrainMailbox(NULL, 0, 0);
+
+	return NULL;
 }                  /* mmpCheckMailbox */
@@ -33,11 +33,85 @@
 #include <address.h>
 #include "mmp_ops.h"
 #include "hwcnt.h"
+#include <scheduler.h>
+
+/*
+ * The first word of a request: our board and core IDs, so that the
+ * other end knows whom to reply to, our load and the opcode.
+ */
+#define MMP_REQUEST(op) \
+	((sysGetIsland() << 19) | (sysGetCore() << 16) | MMP_LOAD_VALID | \
+	 (schdlrLoad() << MMP_LOAD_SHIFT) | (op))
 
 //#define PRINT_NACKS
 
+/*
+ * The layout of the events batch filled by mmpDrainMailbox, keep in
+ * sync with com.sun.squawk.platform.MMP
+ */
+#define MMP_BATCH_OP        0 /* The message type */
+#define MMP_BATCH_KEY       1 /* The object/thread it is about */
+#define MMP_BATCH_TENURE    2 /* The tenure of monitor ACKs and revokes */
+#define MMP_BATCH_SUCCESSOR 3 /* The next owner of revoked monitors or
+                               * the thief of steal requests */
+#define MMP_BATCH_ENTRY     4
+
+/* The maximum messages popped by each mmpDrainMailbox call */
+#ifndef MMP_DRAIN_MAX
+#define MMP_DRAIN_MAX       64
+#endif /* ifndef MMP_DRAIN_MAX */
+
 void    mmpSpawnThread(Address thread);
-Address mmpCheckMailbox(Address type, Address hash);
+void    mmpSpawnThreadNear(Address thread, int core, Address near);
+void    mmpSpawnAll(Address threads, int count);
+void    mmpSteal();
+void    mmpStealReply(int thief, Address thread);
+int     mmpDrainMailbox(Address batch, int length, int load);
+Address mmpCheckMailbox(Address type, Address key);
+
+/*
+ * Non-blocking sends.  The message is posted and its ack is
+ * reconciled later by mmpPoll, which mmpDrainMailbox calls on every
+ * scheduler iteration, re-sending it on Nacks.  Messages to the same
+ * core are still delivered in order, since each post waits for the
+ * previous one to the same core to be acked.  Use mmpFenceTo and
+ * mmpFence to order posts to different cores.
+ *
+ * Whether posting pays off depends on the traffic, compare the
+ * MMP_STATS of a build with and without MMP_BLOCKING.
+ */
+void    mmpPost(int to_bid, int to_cid, unsigned int msg);
+void    mmpPost2(int to_bid, int to_cid, unsigned int msg0, unsigned int msg1);
+void    mmpPost16(int to_bid, int to_cid, unsigned int msg[16]);
+void    mmpPoll();
+void    mmpFenceTo(int to_bid, int to_cid);
+void    mmpFence();
+
+#ifdef MMP_STATS
+/*
+ * The mailbox send statistics of this core, in mmpStats_g.  Blocking
+ * sends count the cycles from the call to the ack, posts only the
+ * cycles until the message is handed to the NI and fences the cycles
+ * spent waiting for posted messages.  Define MMP_BLOCKING to turn the
+ * posts into blocking sends, to compare.
+ */
+enum {
+	MMP_STATS_SENDS = 0,
+	MMP_STATS_SEND_TICKS,
+	MMP_STATS_POSTS,
+	MMP_STATS_POST_TICKS,
+	MMP_STATS_NACKS,
+	MMP_STATS_FENCES,
+	MMP_STATS_FENCE_TICKS,
+	/* NOTE: Update MMP_STATS_COUNT in globals.h when adding counters */
+};
+
+extern void mmp_reset_stats();
+extern void mmp_print_stats();
+#else
+#define mmp_reset_stats()
+#define mmp_print_stats()
+#endif  /* MMP_STATS */
 
 /**
  * Send a single word mailbox message to the given core.
@@ -51,8 +125,16 @@ mmpSend(int to_bid, int to_cid, unsigned int msg)
 {
 	int cnt;
 	int ret;
+#ifdef MMP_STATS
+	unsigned int start = sysGetTicks();
+#endif /* ifdef MMP_STATS */
+
+	/* Do not overtake our posted messages to the same core */
+	if (mmpPendingUsed_g)
+		mmpFenceTo(to_bid, to_cid);
 
 	cnt = hwcnt_get_free(HWCNT_MMP_SEND1);
+	ret = 0;
 
 	do {
 
@@ -76,17 +158,25 @@ mmpSend(int to_bid, int to_cid, unsigned int msg)
 		ar_mbox_send_ack(sysGetCore(), to_bid, to_cid,
 		                 sysGetIsland(), sysGetCore(), cnt, msg);
 
-		/* Spin until counter notification arrives
-		 * FIXME: make it non blocking */
+		/* Spin until counter notification arrives (see mmpPost for
+		 * the non-blocking sends) */
 		while ((ret = ar_cnt_get_triggered(sysGetCore(), cnt)) == 0) {
 			;
 		}
+#ifdef MMP_STATS
+		if (ret == 3)
+			mmpStats_g[MMP_STATS_NACKS]++;
+#endif /* ifdef MMP_STATS */
 	} while (ret == 3); /* Retry on Nack */
 
 	/* kt_printf("Sent\n"); */
 	assume(ret == 2); /* Ack */
 	assume(ar_cnt_get(sysGetCore(), cnt) == 0);
-	hwcnts_g[cnt] = HWCNT_FREE;
+	hwcnt_release(cnt);
+#ifdef MMP_STATS
+	mmpStats_g[MMP_STATS_SENDS]++;
+	mmpStats_g[MMP_STATS_SEND_TICKS] += sysGetTicks() - start;
+#endif /* ifdef MMP_STATS */
 }
 
 /**
@@ -102,6 +192,13 @@ mmpSend2(int to_bid, int to_cid, unsigned int msg0, unsigned int msg1)
 {
 	int cnt;
 	int ret;
+#ifdef MMP_STATS
+	unsigned int start = sysGetTicks();
+#endif /* ifdef MMP_STATS */
+
+	/* Do not overtake our posted messages to the same core */
+	if (mmpPendingUsed_g)
+		mmpFenceTo(to_bid, to_cid);
 
 	cnt = hwcnt_get_free(HWCNT_MMP_SEND2);
 	ret = 0;
@@ -126,16 +223,24 @@ mmpSend2(int to_bid, int to_cid, unsigned int msg0, unsigned int msg1)
 		ar_mbox_send2_ack(sysGetCore(), to_bid, to_cid,
 		                  sysGetIsland(), sysGetCore(), cnt, msg0, msg1);
 
-		/* Spin until counter notification arrives
-		 * FIXME: make it non blocking */
+		/* Spin until counter notification arrives (see mmpPost for
+		 * the non-blocking sends) */
 		while ((ret = ar_cnt_get_triggered(sysGetCore(), cnt)) == 0) {
 			;
 		}
+#ifdef MMP_STATS
+		if (ret == 3)
+			mmpStats_g[MMP_STATS_NACKS]++;
+#endif /* ifdef MMP_STATS */
 	} while (ret == 3);         /* Retry on Nacks */
 
 	assume(ret == 2); /* Ack */
 	assume(ar_cnt_get(sysGetCore(), cnt) == 0);
-	hwcnts_g[cnt] = HWCNT_FREE;
+	hwcnt_release(cnt);
+#ifdef MMP_STATS
+	mmpStats_g[MMP_STATS_SENDS]++;
+	mmpStats_g[MMP_STATS_SEND_TICKS] += sysGetTicks() - start;
+#endif /* ifdef MMP_STATS */
 }
 
 /**
@@ -150,6 +255,9 @@ mmpSend16(int to_bid, int to_cid, unsigned int msg[16])
 {
 	int cnt, ret;
 	unsigned int buff[32], *msg_al;
+#ifdef MMP_STATS
+	unsigned int start = sysGetTicks();
+#endif /* ifdef MMP_STATS */
 
 	/* Align message if needed */
 	if ((unsigned int)msg & 0x3F) {
@@ -157,6 +265,10 @@ mmpSend16(int to_bid, int to_cid, unsigned int msg[16])
 		msg = kt_memcpy(msg_al, msg, 64);
 	}
 
+	/* Do not overtake our posted messages to the same core */
+	if (mmpPendingUsed_g)
+		mmpFenceTo(to_bid, to_cid);
+
 	cnt = hwcnt_get_free(HWCNT_MMP_SEND2);
 	ret = 0;
 
@@ -197,16 +309,24 @@ mmpSend16(int to_bid, int to_cid, unsigned int msg[16])
 		                                                  */
 		                0);                              /* write through */
 
-		/* Spin until counter notification arrives
-		 * FIXME: make it non blocking */
+		/* Spin until counter notification arrives (see mmpPost for
+		 * the non-blocking sends) */
 		while ((ret = ar_cnt_get_triggered(sysGetCore(), cnt)) == 0) {
 			;
 		}
+#ifdef MMP_STATS
+		if (ret == 3)
+			mmpStats_g[MMP_STATS_NACKS]++;
+#endif /* ifdef MMP_STATS */
 	} while (ret == 3);
 
 	assume(ret == 2); /* Ack */
 	assume(ar_cnt_get(sysGetCore(), cnt) == 0);
-	hwcnts_g[cnt] = HWCNT_FREE;
+	hwcnt_release(cnt);
+#ifdef MMP_STATS
+	mmpStats_g[MMP_STATS_SENDS]++;
+	mmpStats_g[MMP_STATS_SEND_TICKS] += sysGetTicks() - start;
+#endif /* ifdef MMP_STATS */
 }
 
 #endif /* RTS_FORMIC_MMP_H */
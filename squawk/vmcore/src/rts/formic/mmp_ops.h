@@ -85,7 +85,29 @@ typedef enum {
 	MMP_OPS_RW_READ_UNLOCK=39,
 	// Monitor manager specials
 	MMP_OPS_MMGR_RESET_STATS=40,
-	MMP_OPS_MMGR_PRINT_STATS=41
+	MMP_OPS_MMGR_PRINT_STATS=41,
+	// Monitor leases
+	MMP_OPS_MNTR_REVOKE=42,
+	MMP_OPS_MNTR_HANDOFF=43,
+	// Atomic Primitives replies
+	MMP_OPS_AT_FAD_R=44,
+	MMP_OPS_AT_SWAP_R=45,
+	// Scheduler
+	MMP_OPS_SCHED_LOAD=46,
+	MMP_OPS_TH_STEAL=47,
+	MMP_OPS_TH_STEAL_R=48,
+	MMP_OPS_TH_STEAL_NACK=49,
+	MMP_OPS_TH_SPAWN_TREE=50
 } mmpMsgOp_t;
 
+/*
+ * The opcode takes the 6 low bits of the first message word's lower
+ * half-word.  Requests (see MMP_REQUEST) also carry their sender's
+ * load in bits 8-14, bit 15 marking it as present.
+ */
+#define MMP_OPS_MASK   0x3F
+#define MMP_LOAD_SHIFT 8
+#define MMP_LOAD_MASK  0x7F
+#define MMP_LOAD_VALID 0x8000
+
 #endif /* _MMP_OPS_H */
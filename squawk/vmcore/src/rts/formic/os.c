@@ -86,32 +86,6 @@ NORETURN void exit(int status) {
 	while (1);
 }
 
-/**
- * Compare and swap.  An asynchronous implementation, sends a request
- * to the atomic primitives manager.  The thread is then added to an
- * event queue waiting for the request to be processed.
- */
-void sysCAS(void* ptr, unsigned int old, unsigned int new) {
-	unsigned int msg[16];
-	int dst_bid, dst_cid;
-
-	/* FIXME: Choose dst_bid and dst_cid somehow */
-	dst_bid = 0x3F;
-	dst_cid = 0;
-
-	kt_memset(msg, 0, sizeof(msg));
-	msg[0] = ((my_bid << 3) | my_cid) << 16 | MMP_OPS_AT_CAS; /* The opcode */
-	msg[1] = (unsigned int)ptr; /* The object address */
-	msg[2] = old;               /* The expected value */
-	msg[3] = new;               /* The new value */
-	mmpSend16(dst_bid, dst_cid, msg);
-
-	/* Empty our software cache.  There is no need to for writing back any dirty
-	 * data, since they should be the result of a data race */
-	/* sc_flush(); */
-	sc_clear();
-}
-
 /**
  * Sets a region of memory read-only or reverts it to read & write.
  *
@@ -42,7 +42,8 @@
 /* Disable non volatile memory */
 #define DEFAULT_NVM_SIZE   0
 
-#define DEFAULT_RAM_SIZE   MM_MB_SLICE_SIZE
+/* The end of the slice might be the monitor managers' (see mmgr.h) */
+#define DEFAULT_RAM_SIZE   (MM_MB_SLICE_SIZE - MMGR_ARENA_SIZE)
 
 /* Try to use the normal C conversions */
 #define C_FP_CONVERSIONS_OK 0
@@ -60,6 +61,7 @@
 #include <myrmics.h>
 #include <errno.h>
 #include <address.h>
+#include <mmgr.h>
 
 #include "jni.h"
 
@@ -109,9 +111,9 @@ extern int __linker_squawk_suite_end;
  */
 INLINE void* sysValloc(size_t size) {
 
-	if (size>MM_MB_SLICE_SIZE) {
+	if (size>MM_MB_SLICE_SIZE - MMGR_ARENA_SIZE) {
 		fprintf(stderr, "Requesting %d Bytes but there are only %d available\n",
-		        size, MM_MB_SLICE_SIZE);
+		        size, MM_MB_SLICE_SIZE - MMGR_ARENA_SIZE);
 		return NULL;
 	}
 
@@ -146,7 +148,6 @@ INLINE jlong sysTimeMillis(void) {
 	return res;
 }
 
-void sysCAS(void* ptr, unsigned int old, unsigned int new);
 void sysToggleMemoryProtection(char* start, char* end, boolean readonly);
 void sysGlobalMemoryProtection();
 
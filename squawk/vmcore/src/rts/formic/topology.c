@@ -0,0 +1,239 @@
+/*
+ * Copyright 2013-2014 FORTH-ICS / CARV
+ *                     (Foundation for Research & Technology -- Hellas,
+ *                      Institute of Computer Science,
+ *                      Computer Architecture & VLSI Systems Laboratory)
+ * DO NOT ALTER OR REMOVE COPYRIGHT NOTICES OR THIS FILE HEADER
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/**
+ * @file   topology.c
+ * @author Foivos S. Zakkak <zakkak@ics.forth.gr>
+ *
+ * @brief The enumeration of the cores running the VM
+ */
+
+#include "topology.h"
+#include "globals.h"
+
+/**
+ * Builds the booted and active boards lists.  Every core must call it
+ * with the same mask, before it spawns threads, requests monitors or
+ * enters a barrier.
+ *
+ * @param maskLow  The boards 0 to 31 to place threads and monitor
+ *                 managers on (bitmap)
+ * @param maskHigh The boards 32 to 63 to place threads and monitor
+ *                 managers on (bitmap)
+ */
+void
+topoInitialize(unsigned int maskLow, unsigned int maskHigh)
+{
+	int          x, y, z, bid, i;
+	unsigned int mask;
+
+	topoBootedCount_g = 0;
+	topoActiveCount_g = 0;
+
+	for (bid = 0; bid < TOPO_MAX_BOARDS; ++bid) {
+		topoBootedIndex_g[bid] = -1;
+		topoActiveIndex_g[bid] = -1;
+	}
+
+	/* The board ID is (x << 4) | (y << 2) | z, so this goes in
+	 * increasing board IDs */
+	for (x = AR_FORMIC_MIN_X; x <= AR_FORMIC_MAX_X; x++)
+		for (y = AR_FORMIC_MIN_Y; y <= AR_FORMIC_MAX_Y; y++)
+			for (z = AR_FORMIC_MIN_Z; z <= AR_FORMIC_MAX_Z; z++) {
+				bid = (x << 4) | (y << 2) | z;
+
+				if (bid == TOPO_RESERVED_BOARD)
+					continue;
+
+				topoBootedIndex_g[bid]            = topoBootedCount_g;
+				topoBooted_g[topoBootedCount_g++] = bid;
+
+				mask = (bid < 32) ? (maskLow >> bid) : (maskHigh >> (bid - 32));
+				if (mask & 1) {
+					topoActiveIndex_g[bid]            = topoActiveCount_g;
+					topoActive_g[topoActiveCount_g++] = bid;
+				}
+			}
+
+	/* A mask with no booted boards means all of them */
+	if (topoActiveCount_g == 0) {
+		for (i = 0; i < topoBootedCount_g; ++i) {
+			topoActiveIndex_g[topoBooted_g[i]] = i;
+			topoActive_g[i]                    = topoBooted_g[i];
+		}
+		topoActiveCount_g = topoBootedCount_g;
+	}
+}
+
+/**
+ * Parses a board mask given in hexadecimal, with or without a 0x
+ * prefix (e.g. 0xFF for the boards 0 to 7).
+ *
+ * @param p        The string to parse
+ * @param maskLow  The boards 0 to 31 (output)
+ * @param maskHigh The boards 32 to 63 (output)
+ * @return 0 on success, -1 if the string is not a 64-bit hex number
+ */
+int
+topoParseMask(const char *p, unsigned int *maskLow, unsigned int *maskHigh)
+{
+	unsigned int low   = 0;
+	unsigned int high  = 0;
+	int          digit = 0;
+	int          ch;
+
+	if (p[0] == '0' && (p[1] == 'x' || p[1] == 'X'))
+		p += 2;
+
+	if (*p == 0)
+		return -1;
+
+	while ((ch = *p++) != 0) {
+		if (ch >= '0' && ch <= '9')
+			ch -= '0';
+		else if (ch >= 'a' && ch <= 'f')
+			ch -= 'a' - 10;
+		else if (ch >= 'A' && ch <= 'F')
+			ch -= 'A' - 10;
+		else
+			return -1;
+
+		if (++digit > 16)
+			return -1;
+
+		high = (high << 4) | (low >> 28);
+		low  = (low << 4) | ch;
+	}
+
+	*maskLow  = low;
+	*maskHigh = high;
+
+	return 0;
+}
+
+/**
+ * Returns the number of active cores.
+ */
+int
+topoCores()
+{
+	return topoActiveCount_g * TOPO_CORES_PER_BOARD;
+}
+
+/**
+ * Returns the given active core.
+ *
+ * @param index The core's index (0 to topoCores()-1)
+ * @return The core packed as (board_ID << 3) | (core_ID)
+ */
+int
+topoCore(int index)
+{
+	return TOPO_CORE(topoActive_g[index / TOPO_CORES_PER_BOARD],
+	                 index % TOPO_CORES_PER_BOARD);
+}
+
+/**
+ * Returns the index of the given core among the active ones.
+ *
+ * @param core The core packed as (board_ID << 3) | (core_ID)
+ * @return The core's index (0 to topoCores()-1), or -1 if it is not
+ *         active
+ */
+int
+topoIndex(int core)
+{
+	int board;
+
+	if (core < 0 || core >= TOPO_MAX_CORES ||
+	    TOPO_CID(core) >= TOPO_CORES_PER_BOARD)
+		return -1;
+
+	board = topoActiveIndex_g[TOPO_BID(core)];
+	if (board < 0)
+		return -1;
+
+	return board * TOPO_CORES_PER_BOARD + TOPO_CID(core);
+}
+
+/**
+ * Returns the number of active boards.
+ */
+int
+topoBoards()
+{
+	return topoActiveCount_g;
+}
+
+/**
+ * Returns the given active board's ID.
+ *
+ * @param index The board's index (0 to topoBoards()-1)
+ */
+int
+topoBoard(int index)
+{
+	return topoActive_g[index];
+}
+
+/**
+ * Returns the number of booted cores, the ones running the VM.
+ */
+int
+topoBootedCores()
+{
+	return topoBootedCount_g * TOPO_CORES_PER_BOARD;
+}
+
+/**
+ * Returns the given booted core.
+ *
+ * @param rank The core's rank (0 to topoBootedCores()-1)
+ * @return The core packed as (board_ID << 3) | (core_ID)
+ */
+int
+topoBootedCore(int rank)
+{
+	return TOPO_CORE(topoBooted_g[rank / TOPO_CORES_PER_BOARD],
+	                 rank % TOPO_CORES_PER_BOARD);
+}
+
+/**
+ * Returns the rank of the given core among the booted ones.
+ *
+ * @param core The core packed as (board_ID << 3) | (core_ID)
+ * @return The core's rank (0 to topoBootedCores()-1), or -1 if it
+ *         does not run the VM
+ */
+int
+topoBootedRank(int core)
+{
+	int board;
+
+	if (core < 0 || core >= TOPO_MAX_CORES ||
+	    TOPO_CID(core) >= TOPO_CORES_PER_BOARD)
+		return -1;
+
+	board = topoBootedIndex_g[TOPO_BID(core)];
+	if (board < 0)
+		return -1;
+
+	return board * TOPO_CORES_PER_BOARD + TOPO_CID(core);
+}
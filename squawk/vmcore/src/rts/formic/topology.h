@@ -0,0 +1,76 @@
+/*
+ * Copyright 2013-2014 FORTH-ICS / CARV
+ *                     (Foundation for Research & Technology -- Hellas,
+ *                      Institute of Computer Science,
+ *                      Computer Architecture & VLSI Systems Laboratory)
+ * DO NOT ALTER OR REMOVE COPYRIGHT NOTICES OR THIS FILE HEADER
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/**
+ * @file   topology.h
+ * @author Foivos S. Zakkak <zakkak@ics.forth.gr>
+ *
+ * @brief The cores running the VM
+ *
+ * The VM runs on the Formic boards in the cube [AR_FORMIC_MIN_X,
+ * AR_FORMIC_MAX_X] x [AR_FORMIC_MIN_Y, AR_FORMIC_MAX_Y] x
+ * [AR_FORMIC_MIN_Z, AR_FORMIC_MAX_Z], except TOPO_RESERVED_BOARD,
+ * using AR_FORMIC_CORES_PER_BOARD cores of each (the booted cores).
+ * The runtime board mask (see -Xboards) narrows the boards that
+ * threads and monitor managers are placed on (the active cores).  The
+ * cores of the masked out boards still take part in the barriers.
+ *
+ * Both sets are enumerated densely, board by board in increasing
+ * board ID, so that partitions get no dead targets.  Cores are packed
+ * as (board_ID << 3) | (core_ID), as in the message headers.
+ */
+
+#ifndef TOPOLOGY_H_
+#define TOPOLOGY_H_
+
+/* The Formic boards and cores the packed IDs can address */
+#define TOPO_MAX_BOARDS 64
+#define TOPO_MAX_CORES  (TOPO_MAX_BOARDS * 8)
+
+/*
+ * The board whose cores do not run the VM (they serve the monitors
+ * with MMGR_PLACE_BOARD, see mmgr.h).  Define it to -1 to run the VM
+ * on all the boards.
+ */
+#ifndef TOPO_RESERVED_BOARD
+#define TOPO_RESERVED_BOARD 0x3F
+#endif /* ifndef TOPO_RESERVED_BOARD */
+
+#define TOPO_CORES_PER_BOARD AR_FORMIC_CORES_PER_BOARD
+
+#define TOPO_CORE(bid, cid) (((bid) << 3) | (cid))
+#define TOPO_BID(core)      ((core) >> 3)
+#define TOPO_CID(core)      ((core) & 0x7)
+
+void topoInitialize(unsigned int maskLow, unsigned int maskHigh);
+int  topoParseMask(const char *p, unsigned int *maskLow,
+                   unsigned int *maskHigh);
+
+int  topoCores();
+int  topoCore(int index);
+int  topoIndex(int core);
+int  topoBoards();
+int  topoBoard(int index);
+
+int  topoBootedCores();
+int  topoBootedCore(int rank);
+int  topoBootedRank(int core);
+
+#endif /* TOPOLOGY_H_ */
@@ -35,6 +35,8 @@
 #include <memory_management.h>
 #include <softcache.h>
 #include <mmgr.h>
+#include <scheduler.h>
+#include <topology.h>
 #include <jni_md.h>
 
 /*
@@ -56,6 +58,43 @@
 // Size of class to class state cache.
 #define CLASS_CACHE_SIZE 6
 
+/*
+ * The number of hwcnt_e values and the number of words in a bitmap of
+ * the hardware counters.  They are defined here to avoid circular
+ * dependencies between the header files globals.h and hwcnt.h .
+ */
+#define HWCNT_USAGES 8
+#define HWCNT_WORDS  4
+
+/*
+ * The number of non-blocking mailbox sends that may be in flight and
+ * the number of MMP_STATS counters (see mmp.h).  They are defined
+ * here to avoid circular dependencies between the header files
+ * globals.h and mmp.h .
+ */
+#define MMP_PENDING_SLOTS 8
+#define MMP_STATS_COUNT   7
+
+/*
+ * The number of write notices kept by the home cores of atomic
+ * primitives, one per group of objects (see apmgr.c).
+ */
+#define APMGR_NOTICE_SLOTS 64
+
+/**
+ * A non-blocking mailbox send waiting for its acknowledgement (see
+ * mmpPost).  The message is kept until it is acked, since the
+ * cache-line messages are DMAed from it and Nacked messages are
+ * re-sent.
+ */
+typedef struct mmp_pending {
+	unsigned int msg[16] __attribute__ ((aligned(MM_CACHELINE_SIZE)));
+	int          size; /**< The message's size in words (1, 2 or 16) */
+	int          bid;  /**< The destination's board ID */
+	int          cid;  /**< The destination's core ID */
+	int          cnt;  /**< The hardware counter of the ack */
+} mmp_pending_st;
+
 /**
  * The default GC chunk, NVM and RAM sizes.
  */
@@ -87,6 +126,12 @@ typedef struct globalsStruct {
 #ifdef __MICROBLAZE__
 	/** The cache directory. */
 	sc_object_st     *_cacheDirectory;
+	/** The number of buckets of the cache directory (a power of two). */
+	int               _cacheDirBuckets;
+	/** The number of tombstones in the cache directory. */
+	int               _cacheDirTombstones;
+	/** The number of chunk records in the cache directory. */
+	int               _cacheChunkRecords;
 	/** Start address of the allocated memory to the software cache. */
 	Address           _cacheStart;
 	/** End address of the allocated memory to the software cache. */
@@ -97,12 +142,62 @@ typedef struct globalsStruct {
 	Address           _cacheAllocTop;
 	/** Temp pointer to the last allocated cache-line if it was not used. */
 	Address           _cacheAllocTemp;
-	/** Counter for the number of flushes due to full cache. */
+	/** End of the already evicted (free) space following the allocation top. */
+	Address           _cacheEvictTop;
+	/** Counter for the number of flushes. */
 	int               _cacheFlushes;
 	/** Counts how many times the cache was cleared. */
 	int               _cacheClears;
 	/** Counter for the number of cached objects. */
 	int               _cacheObjects;
+	/** Counts how many times we had to evict a segment due to full cache. */
+	int               _cacheEvictions;
+	/** Counter for the number of evicted objects. */
+	int               _cacheEvictedObjects;
+	/** Counter for the number of objects invalidated on acquires. */
+	int               _cacheInvalidated;
+	/** Boards written or acquired from (cumulative write notices). */
+	unsigned int      _cacheNotices[SC_NOTICE_WORDS];
+	/** The write notices of the last releases by atomic primitives on our heap slice. */
+	unsigned int      _apmgrNotices[APMGR_NOTICE_SLOTS][SC_NOTICE_WORDS];
+	/** Bitmap of the dirty cache-lines in the software cache. */
+	unsigned int     *_cacheDirtyLines;
+	/** The directory of the read-only partition. */
+	sc_object_st     *_cacheRODirectory;
+	/** The next allocation address in the read-only partition. */
+	Address           _cacheROTop;
+	/** End address of the read-only partition. */
+	Address           _cacheROEnd;
+	/** List of the read-only partition's entries. */
+	sc_object_st     *_cacheROObjects;
+	/** Counter for the look-ups served by the read-only partition. */
+	int               _cacheROHits;
+	/** Counter for the objects fetched in the read-only partition. */
+	int               _cacheROMisses;
+	/** Counts how many times the read-only partition was cleared. */
+	int               _cacheROClears;
+	/** The in-flight prefetches. */
+	sc_prefetch_st    _cachePrefetches[SC_PREFETCH_SLOTS];
+	/** The next slot to use for a prefetch. */
+	int               _cachePrefetchNext;
+	/** Counter for the number of issued prefetches. */
+	int               _cachePrefetchIssued;
+	/** Counter for the number of misses served by prefetches. */
+	int               _cachePrefetchHits;
+	/** The queued write-back runs. */
+	sc_wb_run_st      _cacheWbRuns[SC_WB_BATCH];
+	/** The number of queued write-back runs. */
+	int               _cacheWbCount;
+	/** Counter for the number of written back objects. */
+	int               _cacheWbObjects;
+	/** Counter for the number of issued write-back DMAs. */
+	int               _cacheWbDMAs;
+	/** Counter for the number of array chunks fetched. */
+	int               _cacheChunks;
+	/** Memo of the recently translated objects' directory nodes. */
+	sc_object_st     *_cacheMemo[SC_MEMO_SIZE];
+	/** Counter for the translations served by the memo. */
+	int               _cacheMemoHits;
 	/** List of dirty cached entries. */
 	sc_object_st     *_cacheDirty;
 	/** List of cached entries. */
@@ -111,10 +206,29 @@ typedef struct globalsStruct {
 #error Software caching is only supported on Formic microblazes
 #endif /* __MICROBLAZE__ */
 
-	/** Keeps the last core that the scheduler chose to assign a thread to */
-	int          _schedulerLastCore;
+	/** The scheduler's pseudo-random number generator state */
+	unsigned int _schedulerSeed;
+	/** Our runnable threads (see schdlrSetLoad) */
+	int          _schedulerLoad;
+	/** The loads we know of the other cores (see schdlrNext) */
+	unsigned int _schedulerLoads[TOPO_MAX_CORES];
+
+	/** The boards running the VM (see topology.h) */
+	unsigned char _topoBooted[TOPO_MAX_BOARDS];
+	/** The number of boards running the VM */
+	int           _topoBootedCount;
+	/** The boards to place threads and monitor managers on */
+	unsigned char _topoActive[TOPO_MAX_BOARDS];
+	/** The number of boards to place threads and monitor managers on */
+	int           _topoActiveCount;
+	/** The index of each board in _topoBooted, or -1 */
+	signed char   _topoBootedIndex[TOPO_MAX_BOARDS];
+	/** The index of each board in _topoActive, or -1 */
+	signed char   _topoActiveIndex[TOPO_MAX_BOARDS];
 
 #ifdef HIER_BARRIER
+	/** Keeps the levels of the system barrier trees, 0 if it is centralized */
+	int          _sysBarrierLevels;
 	/** Keeps the next phase for the system barrier */
 	int          _sysBarrierPhase;
 	/** Keeps the number of counters needed for the system barrier */
@@ -142,6 +256,19 @@ typedef struct globalsStruct {
 	 * header files globals.h and hwcnt.h .
 	 */
 	int          _hwcnts[126];
+	/** Bitmap of the allocated hardware counters. */
+	unsigned int _hwcntUsed[HWCNT_WORDS];
+	/** Bitmaps of the allocated hardware counters per usage (hwcnt_e). */
+	unsigned int _hwcntInFlight[HWCNT_USAGES][HWCNT_WORDS];
+
+	/** The non-blocking mailbox sends in flight (see mmpPost). */
+	mmp_pending_st _mmpPending[MMP_PENDING_SLOTS];
+	/** Bitmap of the used _mmpPending slots. */
+	unsigned int   _mmpPendingUsed;
+#ifdef MMP_STATS
+	/** The mailbox send statistics (see mmp_print_stats). */
+	unsigned int   _mmpStats[MMP_STATS_COUNT];
+#endif /* ifdef MMP_STATS */
 
 #ifndef MACROIZE
 	int          _iparm; /* The immediate operand value of the current bytecode. */
@@ -328,14 +455,13 @@ __attribute__((aligned(MM_CACHELINE_SIZE)))
 #ifdef __MICROBLAZE__
 #include "os.h"
 typedef struct {
-	union {
-		/** pointer to the global context */
-		Globals     *global_ctx;
-		/** Monitor Manager Monitors hashtable */
-		mmgrGlobals *mmgr_ctx;
-	};
+	/** pointer to the global context */
+	Globals     *global_ctx;
+	/** Monitor Manager Monitors hashtable (VM cores can be managers
+	 * as well, see MMGR_PLACEMENT) */
+	mmgrGlobals *mmgr_ctx;
 	/* Padding to avoid overlapping with other cores */
-	char padding[MM_CACHELINE_SIZE-sizeof(Globals*)];
+	char padding[MM_CACHELINE_SIZE-sizeof(Globals*)-sizeof(mmgrGlobals*)];
 } globals_box __attribute__((aligned(MM_CACHELINE_SIZE)));
 /* The pointer to the global execution context */
 extern globals_box gps[AR_FORMIC_CORES_PER_BOARD];
@@ -364,23 +490,60 @@ extern __thread Globals kernelGlobals;    /* The kernel mode execution context *
 
 #ifdef __MICROBLAZE__
 #define cacheDirectory_g                    defineGlobal(cacheDirectory)
+#define cacheDirBuckets_g                   defineGlobal(cacheDirBuckets)
+#define cacheDirTombstones_g                defineGlobal(cacheDirTombstones)
+#define cacheChunkRecords_g                 defineGlobal(cacheChunkRecords)
 #define cacheStart_g                        defineGlobal(cacheStart)
 #define cacheEnd_g                          defineGlobal(cacheEnd)
 #define cacheSize_g                         defineGlobal(cacheSize)
 #define cacheAllocTop_g                     defineGlobal(cacheAllocTop)
 #define cacheAllocTemp_g                    defineGlobal(cacheAllocTemp)
+#define cacheEvictTop_g                     defineGlobal(cacheEvictTop)
 #define cacheFlushes_g                      defineGlobal(cacheFlushes)
 #define cacheClears_g                       defineGlobal(cacheClears)
 #define cacheObjects_g                      defineGlobal(cacheObjects)
+#define cacheEvictions_g                    defineGlobal(cacheEvictions)
+#define cacheEvictedObjects_g               defineGlobal(cacheEvictedObjects)
+#define cacheInvalidated_g                  defineGlobal(cacheInvalidated)
+#define cacheNotices_g                      defineGlobal(cacheNotices)
+#define apmgrNotices_g                      defineGlobal(apmgrNotices)
+#define cacheDirtyLines_g                   defineGlobal(cacheDirtyLines)
+#define cachePrefetches_g                   defineGlobal(cachePrefetches)
+#define cachePrefetchNext_g                 defineGlobal(cachePrefetchNext)
+#define cachePrefetchIssued_g               defineGlobal(cachePrefetchIssued)
+#define cachePrefetchHits_g                 defineGlobal(cachePrefetchHits)
+#define cacheRODirectory_g                  defineGlobal(cacheRODirectory)
+#define cacheROTop_g                        defineGlobal(cacheROTop)
+#define cacheROEnd_g                        defineGlobal(cacheROEnd)
+#define cacheROHits_g                       defineGlobal(cacheROHits)
+#define cacheROMisses_g                     defineGlobal(cacheROMisses)
+#define cacheROClears_g                     defineGlobal(cacheROClears)
+#define cacheROObjects_g                    defineGlobal(cacheROObjects)
+#define cacheWbRuns_g                       defineGlobal(cacheWbRuns)
+#define cacheWbCount_g                      defineGlobal(cacheWbCount)
+#define cacheWbObjects_g                    defineGlobal(cacheWbObjects)
+#define cacheWbDMAs_g                       defineGlobal(cacheWbDMAs)
+#define cacheChunks_g                       defineGlobal(cacheChunks)
+#define cacheMemo_g                         defineGlobal(cacheMemo)
+#define cacheMemoHits_g                     defineGlobal(cacheMemoHits)
 #define cacheDirty_g                        defineGlobal(cacheDirty)
 #define cachedObjects_g                     defineGlobal(cachedObjects)
 #else
 #error Software caching is only supported on Formic microblazes
 #endif /* __MICROBLAZE__ */
 
-#define schedulerLastCore_g                 defineGlobal(schedulerLastCore)
+#define schedulerSeed_g                     defineGlobal(schedulerSeed)
+#define schedulerLoad_g                     defineGlobal(schedulerLoad)
+#define schedulerLoads_g                    defineGlobal(schedulerLoads)
+#define topoBooted_g                        defineGlobal(topoBooted)
+#define topoBootedCount_g                   defineGlobal(topoBootedCount)
+#define topoActive_g                        defineGlobal(topoActive)
+#define topoActiveCount_g                   defineGlobal(topoActiveCount)
+#define topoBootedIndex_g                   defineGlobal(topoBootedIndex)
+#define topoActiveIndex_g                   defineGlobal(topoActiveIndex)
 
 #ifdef HIER_BARRIER
+#define sysBarrierLevels_g                  defineGlobal(sysBarrierLevels)
 #define sysBarrierPhase_g                   defineGlobal(sysBarrierPhase)
 #define sysBarrierCounters_g                defineGlobal(sysBarrierCounters)
 #define sysBarrierEnterCounter_g            defineGlobal(sysBarrierEnterCounter)
@@ -392,6 +555,13 @@ extern __thread Globals kernelGlobals;    /* The kernel mode execution context *
 #endif /* HIER_BARRIER */
 
 #define hwcnts_g                            defineGlobal(hwcnts)
+#define hwcntUsed_g                         defineGlobal(hwcntUsed)
+#define hwcntInFlight_g                     defineGlobal(hwcntInFlight)
+#define mmpPending_g                        defineGlobal(mmpPending)
+#define mmpPendingUsed_g                    defineGlobal(mmpPendingUsed)
+#ifdef MMP_STATS
+#define mmpStats_g                          defineGlobal(mmpStats)
+#endif /* ifdef MMP_STATS */
 
 #ifndef MACROIZE
 #define iparm_g                             defineGlobal(iparm)
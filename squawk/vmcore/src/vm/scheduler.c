@@ -28,24 +28,260 @@
  */
 
 #include <os.h>
+#include <topology.h>
+#include "scheduler.h"
 #include "globals.h"
 
+/**
+ * Returns a pseudo-random number (xorshift32).
+ */
+static inline unsigned int
+schdlrRandom()
+{
+	unsigned int x = schedulerSeed_g;
+
+	if (x == 0)
+		x = (((sysGetIsland() << 3) | sysGetCore()) + 1) * 2654435761U;
+
+	x ^= x << 13;
+	x ^= x >> 17;
+	x ^= x << 5;
+	schedulerSeed_g = x;
+
+	return x;
+}
+
+/**
+ * Returns the load we know of the given core, 0 if it is unknown or
+ * too old.
+ *
+ * @param core The core packed as (board_ID << 3) | (core_ID)
+ */
+static inline int
+schdlrLoadOf(int core)
+{
+	unsigned int entry = schedulerLoads_g[core];
+	unsigned int now   = sysGetTicks() >> SCHDLR_STAMP_SHIFT;
+
+	if (((now - (entry >> 8)) & SCHDLR_STAMP_MASK) > SCHDLR_LOAD_TTL)
+		return 0;
+
+	return entry & 0xFF;
+}
+
+/**
+ * Returns a random index in [0, count) other than the two given ones.
+ *
+ * @param count The number of indices
+ * @param x     An index to skip, or -1
+ * @param y     Another index to skip, or -1
+ * @return The index, or -1 if there is none left
+ */
+static inline int
+schdlrRandomIndex(int count, int x, int y)
+{
+	int i, tmp;
+
+	if (y == x)
+		y = -1;
+
+	if (y >= 0 && (x < 0 || y < x)) {
+		tmp = x;
+		x   = y;
+		y   = tmp;
+	}
+
+	count -= (x >= 0) + (y >= 0);
+
+	if (count <= 0)
+		return -1;
+
+	/* Skip the given ones, in increasing order */
+	i = schdlrRandom() % count;
+
+	if (x >= 0 && i >= x)
+		i++;
+	if (y >= 0 && i >= y)
+		i++;
+
+	return i;
+}
+
+/**
+ * Returns a random active core other than us and the given one, or
+ * the given one if there is no other.  If we are the only active core
+ * another booted core is picked instead, and only if the VM runs on
+ * no other core we get us.
+ *
+ * @param self   Our core packed as (board_ID << 3) | (core_ID)
+ * @param except A core to avoid as well, or -1
+ */
+static inline int
+schdlrRandomCore(int self, int except)
+{
+	int i;
+
+	i = schdlrRandomIndex(topoCores(), topoIndex(self), topoIndex(except));
+
+	if (i >= 0)
+		return topoCore(i);
+
+	if (except >= 0)
+		return except;
+
+	i = schdlrRandomIndex(topoBootedCores(), topoBootedRank(self), -1);
+
+	if (i >= 0)
+		return topoBootedCore(i);
+
+	return self;
+}
+
+/**
+ * Record the load of the given core.
+ *
+ * @param bid  The core's board ID
+ * @param cid  The core's core ID
+ * @param load Its runnable threads
+ */
+void
+schdlrSawLoad(int bid, int cid, int load)
+{
+	int core = (bid << 3) | cid;
+
+	if (core >= TOPO_MAX_CORES)
+		return;
+
+	if (load > SCHDLR_LOAD_MAX)
+		load = SCHDLR_LOAD_MAX;
+
+	schedulerLoads_g[core] =
+	    (((sysGetTicks() >> SCHDLR_STAMP_SHIFT) & SCHDLR_STAMP_MASK) << 8) |
+	    load;
+}
+
+/**
+ * Set our load, the runnable threads of this core, as seen by the
+ * scheduler (see VMThread.rescheduleNext).  It is piggybacked on our
+ * requests (see MMP_REQUEST).
+ *
+ * @param load Our runnable threads
+ */
+void
+schdlrSetLoad(int load)
+{
+	schedulerLoad_g = load;
+}
+
+/**
+ * Returns our load, saturated to SCHDLR_LOAD_MAX.
+ */
+int
+schdlrLoad()
+{
+	return (schedulerLoad_g > SCHDLR_LOAD_MAX) ? SCHDLR_LOAD_MAX :
+	       schedulerLoad_g;
+}
+
 /**
  * Peeks a core to schedule the next thread.
  *
+ * We sample two cores at random and pick the least loaded one, as far
+ * as we know (power of two choices).  The loads are learned from the
+ * requests other cores send us and the replies to our spawns (see
+ * mmpReceive).  The chosen core's load is bumped, so that the next
+ * spawns spread until we hear from it again.
+ *
  * @param bid The board to schedule the next thread (output)
  * @param cid The core to schedule the next thread (output)
  */
 void schdlrNext(int *bid, int *cid) {
+	int self, a, b, load, other;
+
+	self = TOPO_CORE(sysGetIsland(), sysGetCore());
 
-	// FIXME: Make it work for various number of cores
-	// Peek a core and a board (FIXME: do something smarter than RR)
-	do {
-		*cid = schedulerLastCore_g & 0x7;
-		*bid = (schedulerLastCore_g >> 3) & 0x3F;
-		schedulerLastCore_g++;
-	} while ( (*bid >= 63) || // HACK disable board 64
-	          ( (*cid == sysGetCore()) && (*bid == sysGetIsland()) ) );
+	a = schdlrRandomCore(self, -1);
+	b = schdlrRandomCore(self, a);
+
+	load  = schdlrLoadOf(a);
+	other = schdlrLoadOf(b);
+
+	if (other < load) {
+		a    = b;
+		load = other;
+	}
+
+	*bid = TOPO_BID(a);
+	*cid = TOPO_CID(a);
+
+	schdlrSawLoad(*bid, *cid, load + 1);
 
 	return;
 }
+
+/**
+ * Peeks a core to schedule the next thread near the given one.  We
+ * never schedule threads on ourselves, so if the given core is us we
+ * pick another random core of our board.
+ *
+ * @param core  The preferred core packed as (board_ID << 3) | (core_ID),
+ *              or -1 to fall back to schdlrNext
+ * @param board Whether any core of the preferred core's board will
+ *              do, in which case we pick the least loaded of it and
+ *              another random core of its board
+ * @param bid   The board to schedule the next thread (output)
+ * @param cid   The core to schedule the next thread (output)
+ */
+void schdlrNear(int core, int board, int *bid, int *cid) {
+	int self, other;
+
+	if (topoIndex(core) < 0) {
+		schdlrNext(bid, cid);
+		return;
+	}
+
+	self = TOPO_CORE(sysGetIsland(), sysGetCore());
+
+	if ((core == self || board) && TOPO_CORES_PER_BOARD > 1) {
+		other = TOPO_CORE(TOPO_BID(core),
+		                  (TOPO_CID(core) + 1 +
+		                   schdlrRandom() % (TOPO_CORES_PER_BOARD - 1)) %
+		                  TOPO_CORES_PER_BOARD);
+
+		if (core == self ||
+		    (other != self && schdlrLoadOf(other) < schdlrLoadOf(core)))
+			core = other;
+	}
+
+	if (core == self) {
+		schdlrNext(bid, cid);
+		return;
+	}
+
+	*bid = TOPO_BID(core);
+	*cid = TOPO_CID(core);
+
+	schdlrSawLoad(*bid, *cid, schdlrLoadOf(core) + 1);
+}
+
+/**
+ * Peeks a core to steal a not yet started thread from, the most
+ * loaded of two random cores as far as we know.
+ *
+ * @param bid The victim's board (output)
+ * @param cid The victim's core (output)
+ */
+void schdlrVictim(int *bid, int *cid) {
+	int self, a, b;
+
+	self = TOPO_CORE(sysGetIsland(), sysGetCore());
+
+	a = schdlrRandomCore(self, -1);
+	b = schdlrRandomCore(self, a);
+
+	if (schdlrLoadOf(b) > schdlrLoadOf(a))
+		a = b;
+
+	*bid = TOPO_BID(a);
+	*cid = TOPO_CID(a);
+}
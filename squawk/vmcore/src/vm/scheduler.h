@@ -30,6 +30,35 @@
 #ifndef VM_SCHEDULER_H
 #define VM_SCHEDULER_H
 
+/*
+ * Threads are placed on the active cores of the topology (see
+ * topology.h).  The loads (runnable threads) we know of them are kept
+ * with the time we learned them, in units of 2^SCHDLR_STAMP_SHIFT
+ * cycles, packed as (stamp << 8) | load.  Loads older than
+ * SCHDLR_LOAD_TTL units are considered unknown.
+ */
+#define SCHDLR_LOAD_MAX     0x7F
+#define SCHDLR_STAMP_SHIFT  16
+#define SCHDLR_STAMP_MASK   0xFFFFFF
+#ifndef SCHDLR_LOAD_TTL
+#define SCHDLR_LOAD_TTL     64
+#endif /* ifndef SCHDLR_LOAD_TTL */
+
+/*
+ * Threads spawned near an object (see mmpSpawnThreadNear) go to the
+ * object's home core.  With -DSCHDLR_NEAR_BOARD=1 they go to the
+ * least loaded of the home core and another random core of its board
+ * instead, trading some locality for balance.
+ */
+#ifndef SCHDLR_NEAR_BOARD
+#define SCHDLR_NEAR_BOARD   0
+#endif /* ifndef SCHDLR_NEAR_BOARD */
+
 void schdlrNext(int *bid, int *cid);
+void schdlrNear(int core, int board, int *bid, int *cid);
+void schdlrVictim(int *bid, int *cid);
+void schdlrSetLoad(int load);
+int  schdlrLoad();
+void schdlrSawLoad(int bid, int cid, int load);
 
 #endif /* VM_SCHEDULER_H */
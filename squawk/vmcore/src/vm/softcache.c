@@ -30,10 +30,34 @@
  * the cache is 8-bytes (2 pointers) per cached object. And the cache
  * can hold up to cache_memory/(cache_line+sizeof(2*(void*))) Objects.
  *
- * We implement the cache directory using double hashing
+ * We implement the cache directory as a hash-table of cache-line sized
+ * buckets with linear probing.  Recent translations are memoized.
+ * Evicted records leave tombstones behind, which get purged by
+ * rehashing the directory in place when they pile up.
  *
- * For the write back DMA acknowledgments we use the hardware counters
- * 90-122
+ * When the cache gets full we evict the oldest objects (FIFO) a
+ * segment at a time, writing back only the evicted dirty ones.
+ *
+ * Dirty data are tracked at cache-line granularity in a bitmap
+ * covering the whole cache.  Write-backs only transfer the dirty
+ * cache lines of an object, one DMA per contiguous dirty run.
+ *
+ * Immutable objects (see is_read_only) live in a separate read-only
+ * partition with its own directory, which survives clears and
+ * evictions.
+ *
+ * Arrays larger than SC_CHUNK_SIZE are cached in chunks that are
+ * fetched on demand (see sc_get_chunk), so sparse accesses to large
+ * arrays only bring the chunks they touch.
+ *
+ * Objects can be prefetched (see sc_prefetch) without blocking.  The
+ * in-flight prefetches are kept in a small table and are completed at
+ * the first use of the object.  On a miss we also prefetch the first
+ * few objects referenced by the fetched one.
+ *
+ * Write-backs are queued and issued in batches, sorted by home
+ * address so that adjacent dirty runs get merged into a single DMA.
+ * All the DMAs of a batch ack on the same hardware counter.
  */
 
 #include "softcache.h"
@@ -51,6 +75,32 @@ void zeroWords(UWordAddress start, UWordAddress end);
 |*                                                                            *|
 \******************************************************************************/
 
+/* Forward declarations */
+static inline void prefetch_cancel_range(Address start, Address end);
+static inline void prefetch_cancel_homes(unsigned int *notices);
+static inline void prefetch_cancel_all();
+static inline int  object_size_and_type(Address oop, int *size_in_bytes);
+static inline int  is_read_only(Address oop);
+
+/**
+ * Checks whether an array is cached in chunks (see SC_CHUNK_SIZE).
+ * Read-only arrays are chunked only if they do not fit in the
+ * read-only partition.
+ *
+ * @param block The cache-line holding the array's header
+ * @param size  The size of the array including its header
+ */
+#define is_chunked(block, size) \
+	((size) > SC_CHUNK_SIZE && ((size) > SC_RO_SIZE || !is_read_only(block)))
+
+/**
+ * The key of the array a cached chunk belongs to, kept in the cache
+ * line following the chunk (see SC_CHUNK_SIZE)
+ *
+ * @param block The cached chunk
+ */
+#define chunk_array(block) (*(UWord*)((block) + SC_CHUNK_SIZE))
+
 /**
  * A node of the directory.  Maps original/remote addresses to local
  * cached object addresses
@@ -71,12 +121,12 @@ struct sc_object {
 };
 
 /**
- * The first hash function
+ * The hash function, returns the first bucket to probe
  *
  * We can safely ignore the 6 LSBs since objects are cache line
  * aligned
  *
- * A simple mod after shifting to the right is still ignoring/dropping
+ * A simple mask after shifting to the right is still ignoring/dropping
  * the 9 MSBs that in our implementation denote the home board and
  * core id of the address. Since all VMs use the same garbage
  * collector we expect objects from different cores to have the "same"
@@ -85,20 +135,18 @@ struct sc_object {
  *
  * @param key The key to hash
  */
-#define dir_hash(key) (((key >> 20) ^ (key >> 6)) % SC_HASHTABLE_SIZE)
+#define dir_hash(key) ((((key) >> 20) ^ ((key) >> 6)) & (cacheDirBuckets_g - 1))
 
 /**
- * The second hash function, used to resolve collisions
+ * Returns the first node of a bucket
  *
- * On collisions we can use the home board and core id info (9MSBs)
- * this way Objects from different homes will follow different probes
- *
- * @param key The key to hash
+ * @param bucket The bucket's index
  */
-#define dir_hash2(key) (key >> 23)
+#define dir_bucket(bucket) (&cacheDirectory_g[(bucket) * SC_BUCKET_NODES])
 
 /**
- * Looks up the cache directory to find the requested object.
+ * Looks up the cache directory to find the requested object.  The
+ * buckets are probed in order, until we find the key or an empty node.
  *
  * @param key The object to look up in the directory
  *
@@ -108,39 +156,34 @@ struct sc_object {
 static inline sc_object_st*
 dir_lookup(UWord key)
 {
-	int          i    = 1;
-	int          hash = dir_hash(key);
-	int          hash2;
-	sc_object_st *ret = &cacheDirectory_g[hash];
-
-	if (((ret->key ^ key) >> 6) == 0)
-		return ret;
-	else if (ret->key) {
-		hash2 = dir_hash2(key);
-
-		while (i < SC_HASHTABLE_SIZE) {
-			hash = (hash + hash2) % SC_HASHTABLE_SIZE;
-			ret  = &cacheDirectory_g[hash];
-
-			if (((ret->key ^ key) >> 6) == 0)
-				return ret;
-			else if (ret->key == NULL)
+	int          i, j;
+	int          bucket = dir_hash(key);
+	sc_object_st *node;
+
+	for (i = 0; i < cacheDirBuckets_g; ++i) {
+		node = dir_bucket(bucket);
+
+		for (j = 0; j < SC_BUCKET_NODES; ++j, ++node) {
+			if (((node->key ^ key) >> 6) == 0)
+				return node;
+			else if (node->key == NULL)
 				return NULL;
 
-			++i;
+			/* Occupied or evicted, keep probing */
 		}
 
-		/* must never reach here */
-		assume(0);
-
-		return NULL;
+		bucket = (bucket + 1) & (cacheDirBuckets_g - 1);
 	}
-	else
-		return NULL;
+
+	/* No empty node, every node is occupied or evicted */
+	return NULL;
 }
 
 /**
- * Inserts a key-value pair in the directory
+ * Inserts a key-value pair in the directory.  Every record holds at
+ * least a cache line of the cache and the directory has at least one
+ * node per cache line (see sc_initialize), so there is always a free
+ * or evicted node to use.
  *
  * @param key The key of the new node
  * @param val The value of the new node
@@ -148,96 +191,413 @@ dir_lookup(UWord key)
 static inline sc_object_st*
 dir_insert(UWord key, UWord val)
 {
-	int          i     = 1;
-	int          hash  = dir_hash(key);
-	int          hash2;
-	sc_object_st *node = &cacheDirectory_g[hash];
+	int          i, j;
+	int          bucket = dir_hash(key);
+	sc_object_st *node;
 
 	assume(!(key & ~SC_ADDRESS_MASK));
 
-	if (node->key == NULL) {
-		node->key = key;
-		node->val = val;
-	}
-	else {
-		hash2 = dir_hash2(key);
+	/*
+	 * The key is not in the directory (we only insert on misses), so
+	 * we can safely reuse the first evicted node we meet
+	 */
+	for (i = 0; i < cacheDirBuckets_g; ++i) {
+		node = dir_bucket(bucket);
 
-		while (i < SC_HASHTABLE_SIZE) {
-			hash = (hash + hash2) % SC_HASHTABLE_SIZE;
-			node = &cacheDirectory_g[hash];
+		for (j = 0; j < SC_BUCKET_NODES; ++j, ++node) {
+			if ((node->key == NULL) || (node->key == SC_DIR_TOMBSTONE)) {
+				if (node->key == SC_DIR_TOMBSTONE)
+					cacheDirTombstones_g--;
 
-			if (node->key == NULL) {
-				node->key = key;
-				node->val = val;
-				break;
+				node->key         = key;
+				node->val         = val;
+				node->next_dirty  = NULL;
+				node->next_cached = cachedObjects_g;
+				cachedObjects_g   = node;
+
+				return node;
 			}
+		}
 
-			++i;
+		bucket = (bucket + 1) & (cacheDirBuckets_g - 1);
+	}
+
+	/* must never reach here, callers do not expect NULL */
+	fatalVMError("Software cache directory is full");
+
+	return NULL;
+}
+
+/**
+ * Marks a directory node as dirty, if it is not already
+ *
+ * @param node The node to mark
+ */
+static inline void
+dir_mark_dirty(sc_object_st *node)
+{
+	if (!(node->key & SC_DIRTY_MASK)) {
+		node->key       |= SC_DIRTY_MASK;
+		assume(node->next_dirty == NULL);
+		node->next_dirty = cacheDirty_g;
+		cacheDirty_g     = node;
+	}
+}
+
+/**
+ * Hash function for the read-only partition's directory, returns the
+ * first bucket to probe (see dir_hash)
+ *
+ * @param key The key to hash
+ */
+#define ro_hash(key) ((((key) >> 20) ^ ((key) >> 6)) & (SC_RO_BUCKETS - 1))
+
+/**
+ * Returns the first node of a bucket of the read-only partition's
+ * directory
+ *
+ * @param bucket The bucket's index
+ */
+#define ro_bucket(bucket) (&cacheRODirectory_g[(bucket) * SC_BUCKET_NODES])
+
+/**
+ * Checks whether a directory node belongs to the read-only partition
+ *
+ * @param node The node to check
+ */
+#define is_ro_node(node)                                                    \
+	(hieq((Address)(node), (Address)cacheRODirectory_g) &&                  \
+	 lo((Address)(node), (Address)(cacheRODirectory_g + SC_RO_LINES)))
+
+/**
+ * Looks up the read-only partition's directory to find the requested
+ * object.  The buckets are probed in order, until we find the key or
+ * an empty node.  The dropped records are tombstones
+ * (SC_DIR_TOMBSTONE) that never match a key, so we just keep probing
+ * past them.
+ *
+ * @param key The object to look up in the directory
+ *
+ * @return The address of the cached object or NULL if it was not
+ *         found
+ */
+static inline sc_object_st*
+ro_lookup(UWord key)
+{
+	int          i, j;
+	int          bucket = ro_hash(key);
+	sc_object_st *node;
+
+	for (i = 0; i < SC_RO_BUCKETS; ++i) {
+		node = ro_bucket(bucket);
+
+		for (j = 0; j < SC_BUCKET_NODES; ++j, ++node) {
+			if (((node->key ^ key) >> 6) == 0)
+				return node;
+			else if (node->key == NULL)
+				return NULL;
 		}
 
-		assume(i < SC_HASHTABLE_SIZE);
+		bucket = (bucket + 1) & (SC_RO_BUCKETS - 1);
 	}
 
-	node->next_dirty  = NULL;
-	node->next_cached = cachedObjects_g;
-	cachedObjects_g   = node;
+	return NULL;
+}
 
-	return node;
+/**
+ * Inserts a key-value pair in the read-only partition's directory
+ *
+ * @param key The key of the new node
+ * @param val The value of the new node
+ *
+ * @return The new node or NULL if the directory is full
+ */
+static inline sc_object_st*
+ro_insert(UWord key, UWord val)
+{
+	int          i, j;
+	int          bucket = ro_hash(key);
+	sc_object_st *node;
+
+	assume(!(key & ~SC_ADDRESS_MASK));
+
+	for (i = 0; i < SC_RO_BUCKETS; ++i) {
+		node = ro_bucket(bucket);
+
+		for (j = 0; j < SC_BUCKET_NODES; ++j, ++node) {
+			if ((node->key == NULL) || (node->key == SC_DIR_TOMBSTONE)) {
+				node->key         = key;
+				node->val         = val;
+				node->next_dirty  = NULL;
+				node->next_cached = cacheROObjects_g;
+				cacheROObjects_g  = node;
+
+				return node;
+			}
+		}
+
+		bucket = (bucket + 1) & (SC_RO_BUCKETS - 1);
+	}
+
+	return NULL;
 }
 
 /**
- * Write back a dirty Object
+ * Drops the records of the read-only partition whose home board is in
+ * the given write notices.  The space of their copies is reclaimed
+ * only when the partition gets cleared (see roalloc).
  *
- * @param from The object to write back
- * @param to   The home address of the object
- * @param size The size of the object
+ * @param notices The boards bitmap (SC_NOTICE_WORDS words)
  *
- * @return The used counter for the ack
+ * @return The number of dropped records
  */
 static inline int
-write_back(Address from, Address to)
+ro_invalidate(unsigned int *notices)
 {
-	int     cnt;
-	/* The object's home node board id */
-	int     to_bid;
-	int     size, length;
-	Address klass;
+	sc_object_st *tmp;
+	sc_object_st **prev;
+	int          bid;
+	int          dropped = 0;
 
-	switch ((*(int*)to) & HDR_headerTagMask) {
+	prev = &cacheROObjects_g;
 
-	case HDR_basicHeaderTag: /* Class Instance */
-		klass = (Address) * (int*)from;
-		size  = com_sun_squawk_Klass_instanceSizeBytes(klass) +
-		        HDR_basicHeaderSize;
-
-		/* printf("klass = %p\n", klass);
-		 * printf("Size = %d HDR = %d name = %s\n", size, HDR_basicHeaderSize,
-		 * com_sun_squawk_Klass_name(
-		 *            klass)); */
-		assume(size != HDR_basicHeaderSize);
+	while ((tmp = *prev)) {
+		sysHomeOfAddress((Address)tmp->key, &bid, NULL);
+		bid--;
 
-		break;
-	case HDR_arrayHeaderTag: /* Array */
-		klass = (Address) * (int*)(from + 4);
+		if (!(notices[bid >> 5] & (1U << (bid & 31)))) {
+			prev = &tmp->next_cached;
+			continue;
+		}
 
-		/* Check if we brought the whole array or not */
-		length = (*(int*)from) >> 2;
-		size   = length *
-		         getDataSize(com_sun_squawk_Klass_componentType(klass)) +
-		         HDR_arrayHeaderSize;
-		break;
-	case HDR_methodHeaderTag: /* Method */
-		printf("%p is a method!\n", to);
+		*prev            = tmp->next_cached;
+		tmp->next_cached = NULL;
+		tmp->key         = SC_DIR_TOMBSTONE;
+		tmp->val         = NULL;
+		dropped++;
+	}
+
+	return dropped;
+}
+
+/**
+ * Drops the record of an object from the read-only partition, if it
+ * is there.  Used when an object we considered immutable is written.
+ *
+ * @param key The object to drop
+ */
+static inline void
+ro_remove(UWord key)
+{
+	sc_object_st *node;
+	sc_object_st **prev;
+
+	if ((node = ro_lookup(key)) == NULL)
+		return;
+
+	prev = &cacheROObjects_g;
+
+	while (*prev != node) {
+		assume(*prev != NULL);
+		prev = &(*prev)->next_cached;
+	}
+
+	*prev             = node->next_cached;
+	node->next_cached = NULL;
+	node->key         = SC_DIR_TOMBSTONE;
+	node->val         = NULL;
+}
+
+/**
+ * Checks whether the i-th cache line of the software cache is dirty
+ *
+ * @param i The index of the cache line
+ */
+#define line_is_dirty(i) (cacheDirtyLines_g[(i) >> 5] & (1U << ((i) & 31)))
+
+/**
+ * Marks the i-th cache line of the software cache as clean
+ *
+ * @param i The index of the cache line
+ */
+#define line_clean(i) (cacheDirtyLines_g[(i) >> 5] &= ~(1U << ((i) & 31)))
+
+/**
+ * Issues the queued write-back DMAs.  The runs are sorted by their
+ * home address, which groups them by home board, and runs that are
+ * adjacent both in the cache and at their home are merged into a
+ * single DMA.  All the DMAs of a batch share the same acknowledgment
+ * counter.
+ */
+static void
+wb_issue()
+{
+	sc_wb_run_st *runs = cacheWbRuns_g;
+	sc_wb_run_st tmp;
+	int          cnt, bid;
+	int          i, j, n;
+	int          bytes;
+	Address      to;
+
+	if (cacheWbCount_g == 0)
+		return;
+
+	/* Sort the runs by home address (insertion sort, batches are small) */
+	for (i = 1; i < cacheWbCount_g; ++i) {
+		tmp = runs[i];
+
+		for (j = i; j > 0 && hi(runs[j - 1].to, tmp.to); --j) {
+			runs[j] = runs[j - 1];
+		}
+
+		runs[j] = tmp;
+	}
+
+	/* Merge the adjacent runs */
+	bytes = runs[0].size;
+
+	for (i = 0, n = 1; n < cacheWbCount_g; ++n) {
+		if (Address_add(runs[i].from, runs[i].size) == runs[n].from &&
+		    Address_add(runs[i].to, runs[i].size) == runs[n].to &&
+		    runs[i].size + runs[n].size <= SC_WB_MAX_DMA) {
+			runs[i].size += runs[n].size;
+		}
+		else {
+			runs[++i] = runs[n];
+		}
+
+		bytes += runs[n].size;
+	}
+
+	cacheWbCount_g = i + 1;
+
+	/* Find an available counter to use */
+	cnt = hwcnt_get_free(HWCNT_SC_WB);
+	assume(cnt >= 0);
+
+	/* Init counter to -bytes, all the DMAs of the batch ack on it */
+	ar_cnt_set(sysGetCore(), cnt, -bytes);
+
+	for (i = 0; i < cacheWbCount_g; ++i) {
+		/* Get the object's home node bid */
+		sysHomeOfAddress(runs[i].to, &bid, NULL);
+		/* bid can't be zero */
+		assume(bid);
+		to = (Address)(((UWord)runs[i].to & 0x3FFFFC0) | MM_MB_HEAP_BASE);
+		/* Add the home board to our write notices */
+		cacheNotices_g[(bid - 1) >> 5] |= 1U << ((bid - 1) & 31);
+
+		/* Wait until our DMA engine can support at least one more DMA */
+		while (!(ar_ni_status_get(sysGetCore()) & 0xFF)) {
+			;
+		}
 
 		/*
-		 * HACK: crash on method header accesses, until we fully
-		 * understand their usage
+		 * Write-backs can be made from the HW cache or the DRAM.  In
+		 * the second case, they are directly passed to the local DRAM
+		 * but have to be pushed to the local DMA engine first.
 		 */
-		fatalVMError("Method header");
-		break;
-	default:
-		fatalVMError("Wrong header tag");
-		break;
+		ar_dma_with_ack(sysGetCore(),   /* my core id */
+		                sysGetIsland(), /* source board id */
+		                sysGetCore(),   /* source core id */
+		                (int)runs[i].from, /* source address */
+		                bid - 1,        /* destination board id */
+		                0xC,            /* destination core id */
+		                (int)to,        /* destination address */
+		                sysGetIsland(), /* ack board id */
+		                sysGetCore(),   /* ack core id */
+		                cnt,            /* ack counter */
+		                runs[i].size,   /* data length */
+		                0,              /* Do not ignore dirty bit on
+		                                 *  source on write-backs, this
+		                                 *  might result in losing writes
+		                                 *  to the software cache */
+		                0,              /* force clean on dst */
+		                1);             /*
+		                                 * write through (doesn't really matter
+		                                 * since we are writing directly on
+		                                 * DRAM)
+		                                 */
+	}
+
+#ifdef SC_STATS
+	cacheWbDMAs_g += cacheWbCount_g;
+#endif /* ifdef SC_STATS */
+
+	cacheWbCount_g = 0;
+}                  /* wb_issue */
+
+/**
+ * Queues a run of dirty cache lines for write-back, issuing the
+ * current batch if it is full.
+ *
+ * @param from The cached copy of the run
+ * @param to   The (global) home address of the run
+ * @param size The size of the run in bytes
+ */
+static inline void
+wb_queue(Address from, Address to, int size)
+{
+	sc_wb_run_st *last;
+
+	if (cacheWbCount_g > 0) {
+		last = &cacheWbRuns_g[cacheWbCount_g - 1];
+
+		/* Most of the time objects are written back in cache order */
+		if (Address_add(last->from, last->size) == from &&
+		    Address_add(last->to, last->size) == to &&
+		    last->size + size <= SC_WB_MAX_DMA) {
+			last->size += size;
+
+			return;
+		}
+
+		if (cacheWbCount_g == SC_WB_BATCH)
+			wb_issue();
+	}
+
+	last       = &cacheWbRuns_g[cacheWbCount_g++];
+	last->from = from;
+	last->to   = to;
+	last->size = size;
+}
+
+/**
+ * Write back the dirty cache lines of an Object.  Every contiguous
+ * run of dirty cache lines is queued for write-back and the DMAs are
+ * issued in batches (see wb_issue).  Use wait_pending_wb() or
+ * wb_issue() to make sure the queued DMAs get issued.
+ *
+ * @param from  The cached copy of the object to write back
+ * @param to    The (global) home address of the object
+ * @param chunk Whether it is a chunk of an array (see SC_CHUNK_SIZE)
+ *
+ * @return 1 if there were dirty cache lines to write back, 0 otherwise
+ */
+static inline int
+write_back(Address from, Address to, int chunk)
+{
+	int size;
+	int first, last, i, run;
+	int dirty = 0;
+
+	if (chunk) {
+		/*
+		 * Chunks are not followed by other objects' cache lines, so
+		 * only the lines actually holding the array can be dirty
+		 */
+		size = SC_CHUNK_SIZE;
+	}
+	else if (object_size_and_type(from, &size) == 0) { /* Class Instance */
+		size += HDR_basicHeaderSize;
+		assume(size != HDR_basicHeaderSize);
+	}
+	else {                                             /* Array */
+		size += HDR_arrayHeaderSize;
+
+		/* Only the first chunk of chunked arrays is here */
+		if (is_chunked(from, size))
+			size = SC_CHUNK_SIZE;
 	}
 
 	/* Make sure we do not cache our own objects */
@@ -248,20 +608,7 @@ write_back(Address from, Address to)
 	 * make sure size <= 1MB, this is the upper limit for a DMA
 	 * transfer
 	 */
-	assume((size > 0) && (size <= 0x100000));
-
-	/* Find an available counter to use */
-	cnt = hwcnt_get_free(HWCNT_SC_WB);
-	assume(cnt >= 0);
-
-	/* kt_printf("Write-back %3d %p to %p size = %d\n", cnt, from, to, size); */
-	/* int i;
-	 * for (i=0; i<size; i+=4) {
-	 *  kt_printf("\t %p\t=%p --> %p\t=%p\n",
-	 *            (UWord)from+i, *(int*)((UWord)from+i),
-	 *            (UWord)to+i, *(int*)((UWord)to+i));
-	 * } */
-	/* sc_dump(); */
+	assume((size > 0) && (size <= SC_WB_MAX_DMA));
 
 	/*
 	 * DMAs are working on cache-line alignment and granularity
@@ -273,59 +620,52 @@ write_back(Address from, Address to)
 	assume(!((UWord)from & ~SC_ADDRESS_MASK) &&
 	       !((UWord)to & ~SC_ADDRESS_MASK));
 
-	/*
-	 * Write-backs can be made from the HW cache or the DRAM.  In the
-	 * second case, they are directly passed to the local DRAM but
-	 * have to be pushed to the local DMA engine first.
-	 */
+	/* Find the range of cache lines the object occupies */
+	first = Address_diff(from, cacheStart_g) / sysGetCachelineSize();
+	last  = first + size / sysGetCachelineSize();
 
-	/* Wait until our DMA engine can support at least one more DMA */
-	while (!(ar_ni_status_get(sysGetCore()) & 0xFF)) {
-		;
-	}
+	/* kt_printf("Write-back %p to %p size = %d\n", from, to, size); */
 
-	/* Init counter to -size */
-	ar_cnt_set(sysGetCore(), cnt, -size);
-	/* Get the object's home node cid and bid */
-	sysHomeOfAddress(to, &to_bid, NULL);
-	/* to_bid can't be zero */
-	assume(to_bid);
-	/* Issue the DMA */
-	ar_dma_with_ack(sysGetCore(),   /* my core id */
-	                sysGetIsland(), /* source board id */
-	                sysGetCore(),   /* source core id */
-	                (int)from,      /* source address */
-	                to_bid - 1,     /* destination board id */
-	                0xC,            /* destination core id */
-	                (int)to,        /* destination address */
-	                sysGetIsland(), /* ack board id */
-	                sysGetCore(),   /* ack core id */
-	                cnt,            /* ack counter */
-	                size,           /* data length */
-	                0,              /* Do not ignore dirty bit on
-	                                 *  source on write-backs, this
-	                                 *  might result in losing writes
-	                                 *  to the software cache */
-	                0,              /* force clean on dst */
-	                1);             /*
-	                                 * write through (doesn't really matter
-	                                 * since we are writing directly on
-	                                 * DRAM)
-	                                 */
-
-	/* while (ar_cnt_get(sysGetCore(), cnt) != 0) {
-	 *  ;
-	 * } */
+	i = first;
 
-	/* sc_dump(); */
+	while (i < last) {
+		/* Skip clean cache lines */
+		if (!line_is_dirty(i)) {
+			++i;
+			continue;
+		}
+
+		/* Find the contiguous run of dirty cache lines */
+		run = i;
+
+		while (run < last && line_is_dirty(run)) {
+			line_clean(run);
+			++run;
+		}
+
+		wb_queue(Address_add(from, (i - first) * sysGetCachelineSize()),
+		         Address_add(to, (i - first) * sysGetCachelineSize()),
+		         (run - i) * sysGetCachelineSize());
+		dirty = 1;
+		i     = run;
+	}
+
+#ifdef SC_STATS
+	cacheWbObjects_g += dirty;
+#endif /* ifdef SC_STATS */
 
-	return cnt;
+	return dirty;
 }                  /* write_back */
 
 /**
- * Wait for all pending write backs to reach completion
+ * Issue the queued write backs and wait for all pending write backs
+ * to reach completion
  */
-#define wait_pending_wb() hwcnt_wait_pending(HWCNT_SC_WB)
+#define wait_pending_wb()                   \
+	do {                                    \
+		wb_issue();                         \
+		hwcnt_wait_pending(HWCNT_SC_WB);    \
+	} while (0)
 
 /**
  * Wait for all pending fetches to reach completion
@@ -348,8 +688,8 @@ dir_clear()
 		if (tmp->key & SC_DIRTY_MASK) {
 			cached = tmp->val & SC_ADDRESS_MASK;
 			write_back((Address)cached,
-			           (Address)(((UWord)tmp->key &
-			                      0x3FFFFC0) | MM_MB_HEAP_BASE));
+			           (Address)(tmp->key & SC_ADDRESS_MASK),
+			           tmp->val & SC_CHUNK_FLAG);
 		}
 
 		cachedObjects_g  = tmp->next_cached;
@@ -361,107 +701,461 @@ dir_clear()
 	wait_pending_wb();
 
 	cacheDirty_g = NULL;
-}
+	cacheChunkRecords_g = 0;
 
-/******************************************************************************\
-|*                                                                            *|
-|*                     Implementation of the cache                            *|
-|*                                                                            *|
-\******************************************************************************/
+	/* The tombstones are not in the cached list, drop them as well */
+	if (cacheDirTombstones_g) {
+		memset(cacheDirectory_g, 0,
+		       cacheDirBuckets_g * SC_BUCKET_NODES * SC_NODE_SIZE);
+		cacheDirTombstones_g = 0;
+	}
+}
 
 /**
- * Initializes the software cache. MUST be invoked before any other
- * function in this file.
+ * Rehashes the directory in place to drop the tombstones.  The live
+ * nodes are first marked as pending and then reinserted one by one.
+ * A node reinserted on a pending one displaces it, and the displaced
+ * node gets reinserted in turn.  Placed nodes never move again, so
+ * the probe sequences stay intact.
+ *
+ * The nodes move, so the cached and dirty lists are rebuilt and the
+ * memo is cleared.  Callers must not hold directory nodes across it.
  */
-void
-sc_initialize()
+static void
+dir_rehash()
 {
-	/* The cache directory. */
-	cacheDirectory_g = (sc_object_st*)roundUp((UWord)mm_scache_base(
-	                                              sysGetCore()),
-	                                          sysGetCachelineSize());
-	/* Start address of the allocated memory to the software cache. */
-	cacheStart_g = (Address)roundUp((UWord)cacheDirectory_g + SC_DIRECTORY_SIZE,
-	                                sysGetCachelineSize());
-	/* End address of the allocated memory to the software cache. */
-	cacheEnd_g = (Address)roundDown((UWord)cacheStart_g + SC_CACHE_SIZE,
-	                                sysGetCachelineSize());
-	/* Size of the software cache in bytes. */
-	cacheSize_g      = cacheEnd_g - cacheStart_g;
-	/* The next allocation address. */
-	cacheAllocTop_g  = cacheStart_g;
-	/* Temp pointer to the last allocated cache-line if it was not used. */
-	cacheAllocTemp_g = NULL;
-	/* Counter for the number of flushes due to full cache. */
-	cacheFlushes_g   = 0;
+	sc_object_st *node;
+	sc_object_st tmp, swap;
+	int          nodes = cacheDirBuckets_g * SC_BUCKET_NODES;
+	int          i, j;
+
+	/* Drop the tombstones and mark the live nodes as pending */
+	for (i = 0; i < nodes; ++i) {
+		node = &cacheDirectory_g[i];
+
+		if (node->key == SC_DIR_TOMBSTONE)
+			node->key = NULL;
+		else if (node->key != NULL)
+			node->key |= SC_DIR_PENDING;
+	}
+
+	for (i = 0; i < nodes; ++i) {
+		if (!(cacheDirectory_g[i].key & SC_DIR_PENDING))
+			continue;
+
+		tmp                     = cacheDirectory_g[i];
+		cacheDirectory_g[i].key = NULL;
+
+		/* Place it at the first empty or pending node it probes */
+		while (tmp.key & SC_DIR_PENDING) {
+			tmp.key &= ~SC_DIR_PENDING;
+			j        = dir_hash(tmp.key) * SC_BUCKET_NODES;
+
+			while (cacheDirectory_g[j].key != NULL &&
+			       !(cacheDirectory_g[j].key & SC_DIR_PENDING)) {
+				j = (j + 1) & (nodes - 1);
+			}
+
+			swap                = cacheDirectory_g[j];
+			cacheDirectory_g[j] = tmp;
+			tmp                 = swap;
+		}
+	}
+
+	/* Rebuild the lists */
+	cachedObjects_g = NULL;
+	cacheDirty_g    = NULL;
+
+	for (i = 0; i < nodes; ++i) {
+		node              = &cacheDirectory_g[i];
+		node->next_cached = NULL;
+		node->next_dirty  = NULL;
+
+		if (node->key == NULL)
+			continue;
+
+		node->next_cached = cachedObjects_g;
+		cachedObjects_g   = node;
+
+		if (node->key & SC_DIRTY_MASK) {
+			node->next_dirty = cacheDirty_g;
+			cacheDirty_g     = node;
+		}
+	}
+
+	memset(cacheMemo_g, 0, sizeof(cacheMemo_g));
+	cacheDirTombstones_g = 0;
+}                  /* dir_rehash */
+
+/**
+ * Rehashes the directory if too many of its nodes are tombstones (see
+ * SC_DIR_TOMBSTONE_RATIO)
+ */
+#define dir_check_tombstones()                                          \
+	do {                                                                \
+		if (unlikely(cacheDirTombstones_g >                             \
+		             cacheDirBuckets_g * SC_BUCKET_NODES /              \
+		             SC_DIR_TOMBSTONE_RATIO))                           \
+			dir_rehash();                                               \
+	} while (0)
+
+/**
+ * Removes the evicted (tombstone) records from the dirty list
+ */
+static inline void
+dir_unlink_evicted_dirty()
+{
+	sc_object_st *tmp;
+	sc_object_st **prev;
+
+	prev = &cacheDirty_g;
+
+	while ((tmp = *prev)) {
+		if (tmp->key == SC_DIR_TOMBSTONE) {
+			*prev           = tmp->next_dirty;
+			tmp->next_dirty = NULL;
+		}
+		else {
+			prev = &tmp->next_dirty;
+		}
+	}
+}
+
+/**
+ * Evicts all records whose cached copy starts in [start, end).  Dirty
+ * records are written back before being dropped.  The evicted nodes
+ * are marked as tombstones to keep the probe sequences of the
+ * remaining records intact.
+ *
+ * @param start The start of the cache region to evict
+ * @param end   The end of the cache region to evict
+ */
+static inline void
+dir_evict(Address start, Address end)
+{
+	sc_object_st *tmp;
+	sc_object_st **prev;
+	UWord        cached;
+	int          dirty = 0;
+
+	prev = &cachedObjects_g;
+
+	while ((tmp = *prev)) {
+		cached = tmp->val & SC_ADDRESS_MASK;
+
+		/* Skip objects outside the evicted region */
+		if (lo(cached, start) || hieq(cached, end)) {
+			prev = &tmp->next_cached;
+			continue;
+		}
+
+		if (tmp->key & SC_DIRTY_MASK) {
+			write_back((Address)cached,
+			           (Address)(tmp->key & SC_ADDRESS_MASK),
+			           tmp->val & SC_CHUNK_FLAG);
+			dirty = 1;
+		}
+
+		if (tmp->val & SC_CHUNK_FLAG)
+			cacheChunkRecords_g--;
+
+		/* Unlink it from the cached objects and mark it as evicted */
+		*prev            = tmp->next_cached;
+		tmp->next_cached = NULL;
+		tmp->key         = SC_DIR_TOMBSTONE;
+		tmp->val         = NULL;
+		cacheDirTombstones_g++;
+#ifdef SC_STATS
+		cacheEvictedObjects_g++;
+#endif /* ifdef SC_STATS */
+	}
+
+	/* Remove the evicted objects from the dirty list as well */
+	if (dirty)
+		dir_unlink_evicted_dirty();
+
+	/* The space is going to be reused, wait for the write-backs */
+	wait_pending_wb();
+
+	dir_check_tombstones();
+}
+
+/**
+ * Drops all records whose home board is in the given write notices.
+ * Dirty records are written back before being dropped.
+ *
+ * @param notices The boards bitmap (SC_NOTICE_WORDS words)
+ *
+ * @return The number of dropped records
+ */
+static inline int
+dir_invalidate(unsigned int *notices)
+{
+	sc_object_st *tmp;
+	sc_object_st **prev;
+	int          bid;
+	int          dropped = 0;
+	int          dirty   = 0;
+
+	prev = &cachedObjects_g;
+
+	while ((tmp = *prev)) {
+		sysHomeOfAddress((Address)(tmp->key & SC_ADDRESS_MASK), &bid, NULL);
+		bid--;
+
+		/* Skip objects whose home was not written */
+		if (!(notices[bid >> 5] & (1U << (bid & 31)))) {
+			prev = &tmp->next_cached;
+			continue;
+		}
+
+		/* NOTE: need to write-back to be safe in case of nested monitor
+		 * acquisition */
+		if (tmp->key & SC_DIRTY_MASK) {
+			write_back((Address)(tmp->val & SC_ADDRESS_MASK),
+			           (Address)(tmp->key & SC_ADDRESS_MASK),
+			           tmp->val & SC_CHUNK_FLAG);
+			dirty = 1;
+		}
+
+		if (tmp->val & SC_CHUNK_FLAG)
+			cacheChunkRecords_g--;
+
+		*prev            = tmp->next_cached;
+		tmp->next_cached = NULL;
+		tmp->key         = SC_DIR_TOMBSTONE;
+		tmp->val         = NULL;
+		cacheDirTombstones_g++;
+		dropped++;
+	}
+
+	if (dirty)
+		dir_unlink_evicted_dirty();
+
+	wait_pending_wb();
+
+	dir_check_tombstones();
+
+	return dropped;
+}
+
+/******************************************************************************\
+|*                                                                            *|
+|*                     Implementation of the cache                            *|
+|*                                                                            *|
+\******************************************************************************/
+
+/**
+ * Counts the cache lines left in a carve-out of the given size, after
+ * the directory, the dirty lines bitmap and the read-only partition
+ * get their space.  Each cache line takes a bit of the bitmap as well,
+ * and up to three lines are lost to aligning the parts.
+ *
+ * @param size    The bytes of the carve-out
+ * @param buckets The number of buckets of the directory
+ */
+static inline int
+cache_lines(int size, int buckets)
+{
+	int rest;
+
+	rest = size - buckets * SC_BUCKET_NODES * SC_NODE_SIZE -
+	       SC_RO_DIRECTORY_SIZE - SC_RO_SIZE - 3 * sysGetCachelineSize();
+
+	return rest > 0 ? rest * 8 / (8 * sysGetCachelineSize() + 1) : 0;
+}
+
+/**
+ * Initializes the software cache. MUST be invoked before any other
+ * function in this file.
+ *
+ * @param size The bytes of the carve-out to use for the software cache
+ *             and its directory, or 0 to use all of it (SC_MAX_SIZE)
+ */
+void
+sc_initialize(int size)
+{
+	int i;
+	int lines, dir_size, map_size;
+
+	if (size <= 0 || size > SC_MAX_SIZE)
+		size = SC_MAX_SIZE;
+	else if (size < SC_MIN_SIZE)
+		size = SC_MIN_SIZE;
+
+	/*
+	 * At least one directory node per cache line, in a power of two
+	 * buckets, so that the directory never gets full (see
+	 * dir_insert).  Start with enough buckets for the whole carve-out
+	 * and halve them while they still cover the lines left after the
+	 * directory takes its space.
+	 */
+	cacheDirBuckets_g = 1;
+
+	while (cacheDirBuckets_g * SC_BUCKET_NODES < cache_lines(size, 0)) {
+		cacheDirBuckets_g *= 2;
+	}
+
+	while (cacheDirBuckets_g > 1 &&
+	       cacheDirBuckets_g / 2 * SC_BUCKET_NODES >=
+	       cache_lines(size, cacheDirBuckets_g / 2)) {
+		cacheDirBuckets_g /= 2;
+	}
+
+	lines    = cache_lines(size, cacheDirBuckets_g);
+	dir_size = cacheDirBuckets_g * SC_BUCKET_NODES * SC_NODE_SIZE;
+	/* One bit per cache line */
+	map_size = ((lines + 31) >> 5) * sizeof(unsigned int);
+
+	/* The cache directory. */
+	cacheDirectory_g = (sc_object_st*)roundUp((UWord)mm_scache_base(
+	                                              sysGetCore()),
+	                                          sysGetCachelineSize());
+	/* The dirty cache-lines bitmap. */
+	cacheDirtyLines_g = (unsigned int*)roundUp((UWord)cacheDirectory_g +
+	                                           dir_size,
+	                                           sysGetCachelineSize());
+	/* The directory of the read-only partition. */
+	cacheRODirectory_g = (sc_object_st*)roundUp((UWord)cacheDirtyLines_g +
+	                                            map_size,
+	                                            sysGetCachelineSize());
+	/* The read-only partition. */
+	cacheROTop_g = (Address)roundUp((UWord)cacheRODirectory_g +
+	                                SC_RO_DIRECTORY_SIZE,
+	                                sysGetCachelineSize());
+	cacheROEnd_g = Address_add(cacheROTop_g, SC_RO_SIZE);
+	/* Start address of the allocated memory to the software cache. */
+	cacheStart_g = cacheROEnd_g;
+	/* End address of the allocated memory to the software cache. */
+	cacheEnd_g = Address_add(cacheStart_g, lines * sysGetCachelineSize());
+	assume(loeq(cacheEnd_g, Address_add(mm_scache_base(sysGetCore()), size)));
+	/* Size of the software cache in bytes. */
+	cacheSize_g      = cacheEnd_g - cacheStart_g;
+	assume(cacheSize_g > 0 && lines <= cacheDirBuckets_g * SC_BUCKET_NODES);
+	/* The next allocation address. */
+	cacheAllocTop_g  = cacheStart_g;
+	/* Temp pointer to the last allocated cache-line if it was not used. */
+	cacheAllocTemp_g = NULL;
+	/* End of the free space, initially the whole cache is free. */
+	cacheEvictTop_g  = cacheEnd_g;
+	/* Counter for the number of flushes. */
+	cacheFlushes_g   = 0;
 	/* Counts how many times the cache was cleared. */
 	cacheClears_g    = 0;
 	/* Counter for the number of cached objects. */
 	cacheObjects_g   = 0;
+	/* Counts how many times we had to evict a segment. */
+	cacheEvictions_g = 0;
+	/* Counter for the number of evicted objects. */
+	cacheEvictedObjects_g = 0;
+	/* No evicted nodes in the directory yet */
+	cacheDirTombstones_g = 0;
+	/* No chunks cached yet */
+	cacheChunkRecords_g = 0;
+	/* Counter for the number of objects invalidated on acquires. */
+	cacheInvalidated_g = 0;
+	/*
+	 * Our own heap slice is written directly, without going through
+	 * the software cache, so our board is always in the notices
+	 */
+	memset(cacheNotices_g, 0, sizeof(cacheNotices_g));
+	cacheNotices_g[sysGetIsland() >> 5] = 1U << (sysGetIsland() & 31);
+	/* No in-flight prefetches */
+	for (i = 0; i < SC_PREFETCH_SLOTS; ++i) {
+		cachePrefetches_g[i].obj = NULL;
+		cachePrefetches_g[i].cnt = -1;
+	}
+	cachePrefetchNext_g   = 0;
+	cachePrefetchIssued_g = 0;
+	cachePrefetchHits_g   = 0;
+	/* No queued write-backs */
+	cacheWbCount_g   = 0;
+	/* Counters for the written back objects and the issued DMAs. */
+	cacheWbObjects_g = 0;
+	cacheWbDMAs_g    = 0;
+	/* Counter for the number of array chunks fetched. */
+	cacheChunks_g = 0;
+	/* Counter for the translations served by the memo. */
+	cacheMemoHits_g = 0;
+	/* Counter for the look-ups served by the read-only partition. */
+	cacheROHits_g = 0;
+	/* Counter for the objects fetched in the read-only partition. */
+	cacheROMisses_g = 0;
+	/* Counts how many times the read-only partition was cleared. */
+	cacheROClears_g = 0;
+	/* List of the read-only partition's entries */
+	cacheROObjects_g = NULL;
 	/* List of dirty entries */
 	cacheDirty_g     = NULL;
 	/* List of cached entries */
 	cachedObjects_g  = NULL;
 
 	/* Make sure the cache is empty */
-	memset(cacheDirectory_g, 0, SC_DIRECTORY_SIZE);
+	memset(cacheDirectory_g, 0, dir_size);
+	memset(cacheMemo_g, 0, sizeof(cacheMemo_g));
+	memset(cacheDirtyLines_g, 0, map_size);
+	memset(cacheRODirectory_g, 0, SC_RO_DIRECTORY_SIZE);
 #if 0
 	fprintf(stderr, "+------------------ SOFTWARE-CACHE -------------------\n");
 	printRange("| Directory", cacheDirectory_g,
-	           (Address)cacheDirectory_g + SC_DIRECTORY_SIZE);
+	           (Address)cacheDirectory_g + dir_size);
 	printRange("| Cache", cacheStart_g, cacheEnd_g);
 	fprintf(stderr, "| CacheSize = %d\n", cacheSize_g);
 	fprintf(stderr, "+-----------------------------------------------------\n");
 #endif /* if 0 */
+}                  /* sc_initialize */
 
-#if 0
-	int start, end;
-
-	if (sysGetCore() == 0 && sysGetIsland() == 0) {
-
-		printf("-------------------- CACHE DUMP STATS --------------------\n");
-
-		start = sysGetTicks();
-		sc_flush(SC_BLOCKING);
-		sc_flush(SC_BLOCKING);
-		sc_flush(SC_BLOCKING);
-		sc_flush(SC_BLOCKING);
-		sc_flush(SC_BLOCKING);
-		end = sysGetTicks();
-		printf(" SW Flush takes:      %10u cc\n", (end - start) / 5);
-
-		start = sysGetTicks();
-		sc_clear();
-		sc_clear();
-		sc_clear();
-		sc_clear();
-		sc_clear();
-		end = sysGetTicks();
-		printf(" SW Clear takes:      %10u cc\n", (end - start) / 5);
-
-		start = sysGetTicks();
-		hwcache_flush();
-		hwcache_flush();
-		hwcache_flush();
-		hwcache_flush();
-		hwcache_flush();
-		end = sysGetTicks();
-		printf(" HW Flush takes:      %10u cc\n", (end - start) / 5);
-
-		start = sysGetTicks();
-		hwcache_flush_clear();
-		hwcache_flush_clear();
-		hwcache_flush_clear();
-		hwcache_flush_clear();
-		hwcache_flush_clear();
-		end = sysGetTicks();
-		printf(" HW FlushClear takes: %10u cc\n", (end - start) / 5);
+/**
+ * Evicts the oldest objects from the software cache to make room for
+ * an allocation of size bytes.  The cache is used as a circular log.
+ * Space is reclaimed at the granularity of segments
+ * (cacheSize_g/SC_EVICT_SEGMENTS), right after the last reclaimed
+ * segment, so that only the oldest objects get evicted.
+ *
+ * @param size The size in bytes (cache line multiple) we need
+ */
+static void
+evict(int size)
+{
+	int     segment;
+	Address start;
+	Address end;
 
-		printf("----------------------------------------------------------\n");
+	segment = roundUp(cacheSize_g / SC_EVICT_SEGMENTS, sysGetCachelineSize());
+
+	/* If it does not fit before the end of the cache, wrap around */
+	if (lt(Address_diff(cacheEnd_g, cacheAllocTop_g), size)) {
+		cacheAllocTop_g = cacheStart_g;
+		cacheEvictTop_g = cacheStart_g;
 	}
 
-#endif /* if 0 */
-}                  /* sc_initialize */
+	start = cacheEvictTop_g;
+	end   = Address_add(cacheStart_g,
+	                    roundUp(Address_diff(Address_add(cacheAllocTop_g, size),
+	                                         cacheStart_g),
+	                            segment));
+
+	if (hi(end, cacheEnd_g))
+		end = cacheEnd_g;
+
+	/* The last unused cache-line might be in the evicted region */
+	if (cacheAllocTemp_g != NULL &&
+	    hieq(cacheAllocTemp_g, start) && lo(cacheAllocTemp_g, end))
+		cacheAllocTemp_g = NULL;
+
+	prefetch_cancel_range(start, end);
+	dir_evict(start, end);
+	cacheEvictTop_g = end;
+
+	/*
+	 * Flush and clear the hardware cache, it might still hold lines
+	 * of the evicted objects.
+	 */
+	hwcache_flush_clear();
+#ifdef SC_STATS
+	cacheEvictions_g++;
+#endif /* ifdef SC_STATS */
+}                  /* evict */
 
 /**
  * Allocate a chunk of memory from the software cache
@@ -474,8 +1168,8 @@ sc_initialize()
 static inline Address
 challoc(int size)
 {
-	Address ret       = cacheAllocTop_g;
-	Offset  available = Address_diff(cacheEnd_g, ret);
+	Address ret;
+	Offset  available;
 
 	size = size ? size : sysGetCachelineSize();
 	assume(size >= 0 && size <= cacheSize_g);
@@ -485,27 +1179,60 @@ challoc(int size)
 	size = roundUp(size, sysGetCachelineSize());
 #endif /* ifdef __MICROBLAZE__ */
 
-	if (unlikely(lt(available, size))) {
-		/* If there is not enough space write back any dirty objects */
-		sc_flush(SC_BLOCKING);
-		/* and clear the cache */
-		sc_clear();
-		/* Try to allocate again */
-		ret = challoc(size);
+	available = Address_diff(cacheEvictTop_g, cacheAllocTop_g);
 
-		assume(ret != NULL);
+	if (unlikely(lt(available, size))) {
+		/* If there is not enough space evict the oldest objects */
+		evict(size);
 	}
-	else {
-		cacheAllocTop_g = Address_add(ret, size);
+
+	ret             = cacheAllocTop_g;
+	cacheAllocTop_g = Address_add(ret, size);
+	assume(loeq(cacheAllocTop_g, cacheEvictTop_g));
 #ifdef ASSUME
-		/* zero the memory */
-		zeroWords(ret, cacheAllocTop_g);
+	/* zero the memory */
+	zeroWords(ret, cacheAllocTop_g);
 #endif /* ifdef ASSUME */
-	}
 
 	return (Address)ret;
 }                  /* challoc */
 
+/**
+ * Allocate a chunk of memory from the read-only partition.  When the
+ * partition gets full it is cleared, reclaiming the space of the
+ * dropped records as well.
+ *
+ * @param   size        the length in bytes of the object and its header
+ * @return a pointer to the allocated memory or NULL if the object does not
+ *         fit in the partition
+ */
+static inline Address
+roalloc(int size)
+{
+	Address ret;
+
+	size = roundUp(size, sysGetCachelineSize());
+
+	if (unlikely(size > SC_RO_SIZE))
+		return NULL;
+
+	if (unlikely(hi(Address_add(cacheROTop_g, size), cacheROEnd_g))) {
+		memset(cacheRODirectory_g, 0, SC_RO_DIRECTORY_SIZE);
+		cacheROObjects_g = NULL;
+		cacheROTop_g     = Address_sub(cacheROEnd_g, SC_RO_SIZE);
+		/* The hardware cache might still hold lines of the old copies */
+		hwcache_flush_clear();
+#ifdef SC_STATS
+		cacheROClears_g++;
+#endif /* ifdef SC_STATS */
+	}
+
+	ret          = cacheROTop_g;
+	cacheROTop_g = Address_add(ret, size);
+
+	return ret;
+}
+
 /**
  * Clears all non read-only records and frees the memory
  */
@@ -513,10 +1240,14 @@ void
 sc_clear()
 {
 	/* printf("SC_CLEAR\n"); */
+	/* drop the in-flight prefetches, they might be stale */
+	prefetch_cancel_all();
 	/* remove the records from the directory */
 	dir_clear();
 	/* reset the allocation pointer */
 	cacheAllocTop_g = cacheStart_g;
+	/* the whole cache is free again */
+	cacheEvictTop_g = cacheEnd_g;
 	/* flush and clear the hardware cache.
 	 * NOTE: Here we need to flush to make sure the software cache
 	 * changes will persist. */
@@ -526,112 +1257,633 @@ sc_clear()
 #endif /* ifdef SC_STATS */
 }
 
+/**
+ * Invalidates the cached objects that might be stale after an
+ * acquire.  The monitor's write notices hold the boards written by
+ * its releasers, so only objects homed on those boards get dropped.
+ * The notices are merged with ours to be passed on at our next
+ * release.
+ *
+ * @param notices The write notices received with the acquire
+ *                (SC_NOTICE_WORDS words)
+ */
+void
+sc_invalidate(unsigned int *notices)
+{
+	int i;
+	int any = 0;
+
+	for (i = 0; i < SC_NOTICE_WORDS; ++i) {
+		cacheNotices_g[i] |= notices[i];
+		any               |= notices[i];
+	}
+
+	if (!any)
+		return;
+
+	prefetch_cancel_homes(notices);
+	i  = dir_invalidate(notices);
+	i += ro_invalidate(notices);
+#ifdef SC_STATS
+	cacheInvalidated_g += i;
+#endif /* ifdef SC_STATS */
+
+	/*
+	 * Objects homed on our board are not in the software cache, but
+	 * the hardware cache might hold stale copies of them.
+	 * NOTE: Here we need to flush to make sure the software cache
+	 * changes will persist.
+	 */
+	i = sysGetIsland();
+
+	if (notices[i >> 5] & (1U << (i & 31)))
+		hwcache_flush_clear();
+}
+
+/**
+ * Issues the DMA fetching a remote object to the software cache
+ * without waiting for its completion.  The given counter gets
+ * initialized to -size and the DMA acknowledges on it.
+ *
+ * @param from The object to fetch
+ * @param to   The address in the cache to store the copy
+ * @param size The size of the object (must be less than 1MB)
+ * @param cid  The core id from whose cache to fetch the data
+ * @param cnt  The counter to acknowledge on
+ */
+static inline void
+fetch_issue(Address from, Address to, int size, int cid, int cnt)
+{
+	/* The object's home node board id */
+	int from_bid;
+
+	/*
+	 * Fetches are directly passed to the remote DRAM but have to be
+	 * pushed to the local DMA engine first.
+	 */
+
+	/* Get the object's home node cid and bid */
+	sysHomeOfAddress(from, &from_bid, NULL);
+	/* from_bid can't be zero */
+	assume(from_bid);
+	/*
+	 * DMAs are working on cache-line alignment and granularity
+	 * (64B). So we round up the size and mask the from address
+	 * accordingly to take the pure, cache-aligned address (offset) on
+	 * the remote node.
+	 */
+	size = roundUp(size, sysGetCachelineSize());
+	from = (Address)(((UWord)from & 0x3FFFFC0) | MM_MB_HEAP_BASE);
+
+	/* Wait until our DMA engine can support at least one more DMA */
+	while ((ar_ni_status_get(sysGetCore()) & 0xFF) == 0) {
+		;
+	}
+
+	/* Init ACK counter to -size */
+	ar_cnt_set(sysGetCore(), cnt, -size);
+	/* Issue the DMA */
+	/* kt_printf("Issued DMA from %p (%d) of size %d\n", from,
+	 *           (cid == -1) ? 0xC : cid, size); */
+	ar_dma_with_ack(sysGetCore(),            /* my core id */
+	                from_bid - 1,            /* source board id */
+	                (cid == -1) ? 0xC : cid, /* source core id */
+	                (int)from,               /* source address */
+	                sysGetIsland(),          /* destination board id */
+	                sysGetCore(),            /* destination core id */
+	                (int)to,                 /* destination address */
+	                sysGetIsland(),          /* ack board id */
+	                sysGetCore(),            /* ack core id */
+	                cnt,                     /* ack counter */
+	                size,                    /* data length */
+	                0,                       /* ignore dirty bit on source */
+	                0,                       /* force clean on dst */
+	                0);                      /* write through */
+}                  /* fetch_issue */
+
 /**
  * Fetch a remote object to the software cache.
  *
- * @param from The object to fetch
- * @param to   The address in the cache to store the copy
- * @param size The size of the object (must be less than 1MB)
- * @param cid  The core id from whose cache to fetch the data
+ * @param from The object to fetch
+ * @param to   The address in the cache to store the copy
+ * @param size The size of the object (must be less than 1MB)
+ * @param cid  The core id from whose cache to fetch the data
+ */
+static void
+fetch(Address from, Address to, int size, int cid)
+{
+	int cnt;
+	int ret;
+
+	/* Make sure we do not cache our own objects */
+	assume(sc_in_heap(from));
+	assume(sc_is_cacheable(from));
+
+	/*
+	 * make sure size <= 1MB, this is the upper limit for a DMA
+	 * transfer
+	 */
+	assume((size > 0) && (size <= 0x100000));
+
+	/* Get an available counter to use */
+	cnt = hwcnt_get_free(HWCNT_SC_FETCH);
+	ret = 0;
+
+	do {
+		/* if (ret) {
+		 * 	kt_printf("DMA from %p Nacked (%d) cnt:%d\n", from,
+		 * 	          ar_cnt_get_triggered(sysGetCore(), cnt), cnt);
+		 * } */
+
+		fetch_issue(from, to, size, cid, cnt);
+
+		/*	printf("Fetch from: %d-%p to %d-%p\n", from_bid, from, sysGetIsland(), to);
+		**/
+
+		/*
+		 * FIXME: We are not sure the DMA reached completion (probably
+		 * not), so for the moment let's just spin here.  Use
+		 * sc_prefetch() to overlap fetches with execution.
+		 */
+		while ((ret = ar_cnt_get_triggered(sysGetCore(), cnt)) == 0) {
+			;
+		}
+
+	} while (ret == 3);         /* Retry on Nacks */
+
+	assume(ret == 2); /* Ack */
+	assume(ar_cnt_get(sysGetCore(), cnt) == 0);
+	/* Mark the counter as available */
+	hwcnt_release(cnt);
+
+	/* kt_printf("Fetched %3d %p from %p size = %d\n", cnt, to, from, size);
+	 * sc_dump(); */
+	/* kt_printf("Fetched klass = %p to = %p name = %s\n", *(int*)to, to,
+	 * com_sun_squawk_Klass_name(
+	 *               *(int*)to)); */
+
+}                  /* fetch */
+
+/******************************************************************************\
+|*                                                                            *|
+|*                Prefetching                                                 *|
+|*                                                                            *|
+\******************************************************************************/
+
+/**
+ * Looks up the in-flight prefetches for the given object.
+ *
+ * @param obj The object to look for
+ *
+ * @return The prefetch slot or NULL if it is not being prefetched
+ */
+static inline sc_prefetch_st*
+prefetch_lookup(Address obj)
+{
+	int i;
+
+	for (i = 0; i < SC_PREFETCH_SLOTS; ++i) {
+		if (((UWord)cachePrefetches_g[i].obj & SC_ADDRESS_MASK) ==
+		    ((UWord)obj & SC_ADDRESS_MASK))
+			return &cachePrefetches_g[i];
+	}
+
+	return NULL;
+}
+
+/**
+ * Drops a prefetch.  If its DMA is still in flight we wait for it
+ * since it is writing to memory that is going to be reused.
+ *
+ * @param p The prefetch slot to drop
+ */
+static inline void
+prefetch_cancel(sc_prefetch_st *p)
+{
+	if (p->cnt >= 0) {
+		/* Acked or Nacked, the DMA is not writing any more */
+		while (ar_cnt_get_triggered(sysGetCore(), p->cnt) == 0) {
+			;
+		}
+
+		hwcnt_release(p->cnt);
+		p->cnt = -1;
+	}
+
+	p->obj = NULL;
+}
+
+/**
+ * Drops the prefetches fetching to the given cache region.
+ *
+ * @param start The start of the cache region
+ * @param end   The end of the cache region
+ */
+static inline void
+prefetch_cancel_range(Address start, Address end)
+{
+	int i;
+
+	for (i = 0; i < SC_PREFETCH_SLOTS; ++i) {
+		if (cachePrefetches_g[i].obj != NULL &&
+		    hieq(cachePrefetches_g[i].block, start) &&
+		    lo(cachePrefetches_g[i].block, end))
+			prefetch_cancel(&cachePrefetches_g[i]);
+	}
+}
+
+/**
+ * Drops the prefetches of objects whose home board is in the given
+ * write notices, they might be stale.
+ *
+ * @param notices The boards bitmap (SC_NOTICE_WORDS words)
+ */
+static inline void
+prefetch_cancel_homes(unsigned int *notices)
+{
+	int i;
+	int bid;
+
+	for (i = 0; i < SC_PREFETCH_SLOTS; ++i) {
+		if (cachePrefetches_g[i].obj == NULL)
+			continue;
+
+		sysHomeOfAddress(cachePrefetches_g[i].obj, &bid, NULL);
+		bid--;
+
+		if (notices[bid >> 5] & (1U << (bid & 31)))
+			prefetch_cancel(&cachePrefetches_g[i]);
+	}
+}
+
+/**
+ * Drops all the prefetches.
+ */
+static inline void
+prefetch_cancel_all()
+{
+	int i;
+
+	for (i = 0; i < SC_PREFETCH_SLOTS; ++i) {
+		if (cachePrefetches_g[i].obj != NULL)
+			prefetch_cancel(&cachePrefetches_g[i]);
+	}
+}
+
+/**
+ * Progresses a prefetch.  Nacked DMAs are reissued and, as soon as the
+ * first cache line of an object arrives, the rest of it gets
+ * prefetched as well.
+ *
+ * @param p        The prefetch slot
+ * @param blocking Whether to wait until the whole object is here
+ *
+ * @return 1 if the prefetch completed, 0 otherwise
+ */
+static int
+prefetch_poll(sc_prefetch_st *p, int blocking)
+{
+	Address obj;
+	int     ret;
+	int     size;
+
+	while (p->cnt >= 0) {
+		ret = ar_cnt_get_triggered(sysGetCore(), p->cnt);
+
+		if (ret == 0) {        /* Pending */
+			if (!blocking)
+				return 0;
+
+			continue;
+		}
+		else if (ret == 3) {   /* Nacked, retry */
+			fetch_issue(p->obj, p->block, p->size, -1, p->cnt);
+
+			if (!blocking)
+				return 0;
+
+			continue;
+		}
+
+		assume(ret == 2); /* Ack */
+		hwcnt_release(p->cnt);
+		p->cnt = -1;
+
+		if (p->whole)
+			break;
+
+		/* The header is here, find the object's size */
+		p->whole = 1;
+		ret      = object_size_and_type(p->block, &size);
+		size    += ret ? HDR_arrayHeaderSize : HDR_basicHeaderSize;
+
+		/* Only the first chunk of chunked arrays is cached */
+		if (ret && is_chunked(p->block, size))
+			size = SC_CHUNK_SIZE;
+
+		/*
+		 * Objects larger than a segment are left for block_to_oop to
+		 * fetch at first use
+		 */
+		if (size <= p->size ||
+		    size > cacheSize_g / SC_EVICT_SEGMENTS)
+			break;
+
+		/*
+		 * Prefetch the whole object.  The allocation might evict the
+		 * first cache line and drop this prefetch, so keep the object.
+		 */
+		obj              = p->obj;
+		cacheAllocTemp_g = p->block;
+		ret              = hwcnt_get_free(HWCNT_SC_PREFETCH);
+		p->block         = challoc(size);
+		p->obj           = obj;
+		p->size          = size;
+		p->cnt           = ret;
+		fetch_issue(obj, p->block, size, -1, ret);
+	}
+
+	return 1;
+}                  /* prefetch_poll */
+
+/**
+ * Progresses all in-flight prefetches without blocking.
+ */
+void
+sc_prefetch_progress()
+{
+	int i;
+
+	for (i = 0; i < SC_PREFETCH_SLOTS; ++i) {
+		if (cachePrefetches_g[i].obj != NULL &&
+		    cachePrefetches_g[i].cnt >= 0)
+			prefetch_poll(&cachePrefetches_g[i], 0);
+	}
+}
+
+/**
+ * Starts fetching an object or an array chunk to the software cache
+ * without waiting for it.  The prefetch is silently dropped if there
+ * is no free counter.
+ *
+ * @param obj   The object or array chunk to prefetch
+ * @param array The array of the chunk or NULL for objects
+ * @param size  The size of the chunk or 0 for objects, whose size is
+ *              not known a priori
+ */
+static inline void
+prefetch_issue(Address obj, Address array, int size)
+{
+	sc_prefetch_st *p;
+	Address        block;
+	int            cnt;
+
+	/* Never wait for a counter */
+	cnt = hwcnt_try_get(HWCNT_SC_PREFETCH);
+
+	if (cnt == -1)
+		return;
+
+	/* Take the next slot, dropping the oldest prefetch if needed */
+	p                   = &cachePrefetches_g[cachePrefetchNext_g];
+	cachePrefetchNext_g = (cachePrefetchNext_g + 1) % SC_PREFETCH_SLOTS;
+
+	if (p->obj != NULL)
+		prefetch_cancel(p);
+
+	if (size) {
+		/*
+		 * Chunks always occupy a whole chunk (see write_back),
+		 * followed by their array's key
+		 */
+		block              = challoc(SC_CHUNK_SIZE + sysGetCachelineSize());
+		chunk_array(block) = (UWord)array;
+	}
+	else if (cacheAllocTemp_g != NULL) {
+		block            = cacheAllocTemp_g;
+		cacheAllocTemp_g = NULL;
+	}
+	else {
+		block = challoc(0);
+	}
+
+	p->obj   = obj;
+	p->block = block;
+	p->array = array;
+	p->size  = size ? size : sysGetCachelineSize();
+	p->whole = size != 0;
+	p->cnt   = cnt;
+	fetch_issue(obj, block, p->size, -1, cnt);
+#ifdef SC_STATS
+	cachePrefetchIssued_g++;
+#endif /* ifdef SC_STATS */
+}                  /* prefetch_issue */
+
+/**
+ * Starts fetching an object to the software cache without waiting for
+ * it.  The fetch is completed at the first use of the object.
+ *
+ * @param obj The object to prefetch
+ */
+void
+sc_prefetch(Address obj)
+{
+	if (obj == NULL || !sc_in_heap(obj) || !sc_is_cacheable(obj))
+		return;
+
+	/* Skip the cached or already prefetched objects */
+	if (dir_lookup((UWord)obj) != NULL || ro_lookup((UWord)obj) != NULL ||
+	    prefetch_lookup(obj) != NULL)
+		return;
+
+	prefetch_issue(obj, NULL, 0);
+}
+
+/**
+ * Starts fetching the elements [from, to) of an array to the software
+ * cache without waiting for them.  If the array is not cached yet only
+ * its head is prefetched, since we need its header to locate the
+ * chunks.  Arrays that are not chunked are cached whole.
+ *
+ * @param array The array to prefetch
+ * @param from  The first element to prefetch
+ * @param to    The element after the last one to prefetch
  */
-static void
-fetch(Address from, Address to, int size, int cid)
+void
+sc_prefetch_range(Address array, int from, int to)
 {
-	int cnt;
-	/* The object's home node board id */
-	int from_bid;
-	int ret;
+	sc_object_st *node;
+	Address      block;
+	UWord        key;
+	int          size, elem, head, chunk, last;
 
-	/* Make sure we do not cache our own objects */
-	assume(sc_in_heap(from));
-	assume(sc_is_cacheable(from));
+	if (from >= to || array == NULL || !sc_in_heap(array) ||
+	    !sc_is_cacheable(array))
+		return;
 
-	/*
-	 * make sure size <= 1MB, this is the upper limit for a DMA
-	 * transfer
-	 */
-	assume((size > 0) && (size <= 0x100000));
+	node = dir_lookup((UWord)array);
 
-	/* Get an available counter to use */
-	cnt = hwcnt_get_free(HWCNT_SC_FETCH);
-	ret = 0;
+	if (node == NULL) {
+		sc_prefetch(array);
 
-	/*
-	 * Fetches are directly passed to the remote DRAM but have to be
-	 * pushed to the local DMA engine first.
-	 */
+		return;
+	}
 
-	/* Get the object's home node cid and bid */
-	sysHomeOfAddress(from, &from_bid, NULL);
-	/* from_bid can't be zero */
-	assume(from_bid);
-	/*
-	 * DMAs are working on cache-line alignment and granularity
-	 * (64B). So we round up the size and mask the from address
-	 * accordingly to take the pure, cache-aligned address (offset) on
-	 * the remote node.
-	 */
-	size = roundUp(size, sysGetCachelineSize());
-	from = (Address)(((UWord)from & 0x3FFFFC0) | MM_MB_HEAP_BASE);
+	block = (Address)(node->val & SC_ADDRESS_MASK);
 
-	do {
-		/* if (ret) {
-		 * 	kt_printf("DMA from %d:%d Nacked (%d) cnt:%d from:%p\n", from_bid, cid,
-		 * 	          ar_cnt_get_triggered(sysGetCore(), cnt), cnt, from);
-		 * } */
+	if (object_size_and_type(block, &size) != 1 ||
+	    !is_chunked(block, size + HDR_arrayHeaderSize))
+		return;
 
-		/* Wait until our DMA engine can support at least one more DMA */
-		while ((ar_ni_status_get(sysGetCore()) & 0xFF) == 0) {
-			;
-		}
+	/* Find the chunks holding the requested elements */
+	elem  = getDataSize(com_sun_squawk_Klass_componentType(
+	                        (Address) * (int*)(block + 4)));
+	head  = (UWord)array & ~SC_ADDRESS_MASK;
+	chunk = (head + from * elem) / SC_CHUNK_SIZE;
+	last  = (head + to * elem - 1) / SC_CHUNK_SIZE;
+	size += HDR_arrayHeaderSize;
 
-		/* Init ACK counter to -size */
-		ar_cnt_set(sysGetCore(), cnt, -size);
-		/* Issue the DMA */
-		/* kt_printf("Issued DMA from %p (%d) of size %d\n", from,
-		 *           (cid == -1) ? 0xC : cid, size); */
-		ar_dma_with_ack(sysGetCore(),            /* my core id */
-		                from_bid - 1,            /* source board id */
-		                (cid == -1) ? 0xC : cid, /* source core id */
-		                (int)from,               /* source address */
-		                sysGetIsland(),          /* destination board id */
-		                sysGetCore(),            /* destination core id */
-		                (int)to,                 /* destination address */
-		                sysGetIsland(),          /* ack board id */
-		                sysGetCore(),            /* ack core id */
-		                cnt,                     /* ack counter */
-		                size,                    /* data length */
-		                0,                       /* ignore dirty bit on source */
-		                0,                       /* force clean on dst */
-		                0);                      /* write through */
+	/* The first chunk is the array's head which is already here */
+	if (chunk == 0)
+		chunk = 1;
 
-		/*	printf("Fetch from: %d-%p to %d-%p\n", from_bid, from, sysGetIsland(), to);
-		**/
+	for (; chunk <= last; ++chunk) {
+		key = ((UWord)array & SC_ADDRESS_MASK) + chunk * SC_CHUNK_SIZE;
 
-		/*
-		 * FIXME: We are not sure the DMA reached completion (probably
-		 * not), so for the moment let's just spin here. Note that this
-		 * must be fixed in order to make prefetching work efficiently
-		 * FIXME: Add check for Nack and retry if necessary
-		 */
-		while ((ret = ar_cnt_get_triggered(sysGetCore(), cnt)) == 0) {
-			;
+		if (dir_lookup(key) != NULL || prefetch_lookup((Address)key) != NULL)
+			continue;
+
+		prefetch_issue((Address)key, (Address)((UWord)array & SC_ADDRESS_MASK),
+		               min(size - chunk * SC_CHUNK_SIZE, SC_CHUNK_SIZE));
+	}
+}                  /* sc_prefetch_range */
+
+/**
+ * Prefetches the objects referenced by a newly cached object, up to
+ * SC_PREFETCH_FIELDS of them.  Only instances with a single word oop
+ * map and reference arrays are considered.
+ *
+ * @param oop The cached object
+ */
+static inline void
+prefetch_refs(Address oop)
+{
+	Address klass;
+	Address ref;
+	UWord   map;
+	int     i, n, length;
+
+	klass = (Address) * (int*)(oop - HDR_BYTES_PER_WORD);
+	n     = 0;
+
+	if (com_sun_squawk_Klass_modifiers(klass) & com_sun_squawk_Modifier_ARRAY) {
+		if (com_sun_squawk_Klass_modifiers(
+		        com_sun_squawk_Klass_componentType(klass)) &
+		    (com_sun_squawk_Modifier_PRIMITIVE |
+		     com_sun_squawk_Modifier_SQUAWKPRIMITIVE))
+			return;
+
+		length = (*(int*)(oop - HDR_arrayHeaderSize)) >> 2;
+
+		/* Stay in the first chunk */
+		length = min(length, (SC_CHUNK_SIZE - HDR_arrayHeaderSize) /
+		             HDR_BYTES_PER_WORD);
+
+		for (i = 0; i < length && n < SC_PREFETCH_FIELDS; ++i) {
+			if ((ref = ((Address*)oop)[i]) != NULL) {
+				sc_prefetch(ref);
+				n++;
+			}
+		}
+	}
+	else {
+		if (com_sun_squawk_Klass_instanceSizeBytes(klass) >
+		    HDR_BITS_PER_WORD * HDR_BYTES_PER_WORD)
+			return;
+
+		map = com_sun_squawk_Klass_oopMapWord(klass);
+
+		for (i = 0; map != 0 && n < SC_PREFETCH_FIELDS; ++i, map >>= 1) {
+			if ((map & 1) && (ref = ((Address*)oop)[i]) != NULL) {
+				sc_prefetch(ref);
+				n++;
+			}
 		}
+	}
+}                  /* prefetch_refs */
 
-	} while (ret == 3);         /* Retry on Nacks */
+/**
+ * Checks whether the object held in the given cache-line is immutable
+ * once published, according to the KLASS_IMMUTABLE modifier the
+ * translator sets to the strings and the classes with only final
+ * instance fields.  Classes are not, their state changes while they
+ * get initialized.
+ *
+ * @param oop The cache-line holding the object's head
+ *
+ * @return 1 if the object is read-only, 0 otherwise
+ */
+static inline int
+is_read_only(Address oop)
+{
+	Address klass;
 
-	assume(ret == 2); /* Ack */
-	assume(ar_cnt_get(sysGetCore(), cnt) == 0);
-	/* Mark the counter as available */
-	hwcnts_g[cnt] = HWCNT_FREE;
+	switch ((*(int*)oop) & HDR_headerTagMask) {
 
-	/* kt_printf("Fetched %3d %p from %p size = %d\n", cnt, to, from, size);
-	 * sc_dump(); */
-	/* kt_printf("Fetched klass = %p to = %p name = %s\n", *(int*)to, to,
-	 * com_sun_squawk_Klass_name(
-	 *               *(int*)to)); */
+	case HDR_basicHeaderTag: /* Class Instance */
+		klass = (Address) * (int*)oop;
+		break;
+	case HDR_arrayHeaderTag: /* Array */
+		klass = (Address) * (int*)(oop + 4);
+		break;
+	default:
+		return 0;
+	}
 
-}                  /* fetch */
+	return (com_sun_squawk_Klass_modifiers(klass) &
+	        com_sun_squawk_Modifier_KLASS_IMMUTABLE) != 0;
+}
+
+/**
+ * Moves a read-only object to the read-only partition.  The first
+ * cache-line is copied and the rest of the object, if any, is
+ * fetched.  The cache-line in the normal partition is left for the
+ * next allocation.
+ *
+ * @param obj       The object's global address
+ * @param oop       The cache-line holding the object's head
+ * @param size      The size of the object including its header
+ * @param fetched   The number of bytes of the object already in oop
+ * @param cid       The core id to fetch the rest of the object from
+ * @param read_only Reset if the object does not fit in the read-only
+ *                  partition (return)
+ *
+ * @return The object's block in the read-only partition or oop if it
+ *         does not fit
+ */
+static inline Address
+ro_move(Address obj, Address oop, int size, int fetched, int cid,
+        int *read_only)
+{
+	Address block;
+
+	block = roalloc(size);
+
+	if (unlikely(block == NULL)) {
+		*read_only = 0;
+
+		return oop;
+	}
+
+	if (size > fetched)
+		fetch(obj, block, size, cid);
+	else
+		memcpy(block, oop, roundUp(size, sysGetCachelineSize()));
+
+	cacheAllocTemp_g = oop;
+
+	return block;
+}
 
 /**
  * Get the address at which the body of an object starts given the
@@ -665,9 +1917,19 @@ fetch(Address from, Address to, int size, int cid)
  *
  * This is actually a clone of blockToOop from
  * cldc/src/com/sun/squawk/GC.java
+ *
+ * Read-only objects are moved to the read-only partition.  If they do
+ * not fit read_only gets reset and the object stays in the normal
+ * partition, chunked if it is a large array.
+ *
+ * @param obj       The object's global address
+ * @param oop       The cache-line(s) holding the object's head
+ * @param cid       The core id to fetch the rest of the object from
+ * @param fetched   The number of bytes of the object already in oop
+ * @param read_only Whether the object is read-only (in/out)
  */
 static inline Address
-block_to_oop(Address obj, Address oop, int cid)
+block_to_oop(Address obj, Address oop, int cid, int fetched, int *read_only)
 {
 	int     size, length;
 	Address klass;
@@ -690,11 +1952,14 @@ block_to_oop(Address obj, Address oop, int cid)
 		 * printf("Find size took %10u cc \n", end - start); */
 		/* printf("Klass size = %d\n", size); */
 
+		if (unlikely(*read_only))
+			oop = ro_move(obj, oop, size, fetched, cid, read_only);
+
 		/*
 		 * If the instance size is larger than the cache-line we need
 		 * to fetch the rest
 		 */
-		if (unlikely(size > sysGetCachelineSize())) {
+		if (unlikely(!*read_only && size > fetched)) {
 			/* start            = sysGetTicks(); */
 			cacheAllocTemp_g = oop;
 			oop              = challoc(size);
@@ -720,15 +1985,17 @@ block_to_oop(Address obj, Address oop, int cid)
 		         HDR_arrayHeaderSize;
 		/* printf("Array [%d] size = %d\n", length, size); */
 
+		if (unlikely(*read_only))
+			oop = ro_move(obj, oop, size, fetched, cid, read_only);
+
+		if (unlikely(!*read_only && is_chunked(oop, size)))
+			size = SC_CHUNK_SIZE; /* The rest is fetched on demand */
+
 		/*
 		 * If the instance size times the array elements is larger
 		 * than the cache-line we need to fetch the rest
 		 */
-		if (likely(size > sysGetCachelineSize())) {
-			/*
-			 * TODO: Do something smarter for arrays (don't bring the
-			 * whole array if we don't need it)
-			 */
+		if (likely(!*read_only && size > fetched)) {
 			cacheAllocTemp_g = oop;
 			oop              = challoc(size);
 			/* Fetch data */
@@ -765,16 +2032,32 @@ block_to_oop(Address obj, Address oop, int cid)
  * obj is fetched from that core's cache instead of the board's main
  * memory.
  *
- * @param obj The object to cache
- * @param cid  The core id to fetch it from
+ * @param obj     The object to cache
+ * @param cid     The core id to fetch it from
+ * @param allow_ro Whether the object may go to the read-only partition
  *
  * @return The cached object
  */
-sc_object_st*
-sc_put(Address obj, int cid)
+static inline sc_object_st*
+put(Address obj, int cid, int allow_ro)
 {
-	Address      ret;
-	sc_object_st *node;
+	Address        ret;
+	sc_object_st   *node;
+	sc_prefetch_st *p;
+	int            read_only;
+	int            fetched;
+
+	/* If it is being prefetched, wait for it and use it */
+	if (cid == -1 && (p = prefetch_lookup(obj)) != NULL) {
+		prefetch_poll(p, 1);
+		ret     = p->block;
+		fetched = p->size;
+		p->obj  = NULL;
+#ifdef SC_STATS
+		cachePrefetchHits_g++;
+#endif /* ifdef SC_STATS */
+		goto fetched;
+	}
 
 	if (unlikely(cacheAllocTemp_g != NULL)) {
 		/*
@@ -796,9 +2079,12 @@ sc_put(Address obj, int cid)
 	/* Fetch data */
 	/* start = sysGetTicks(); */
 	fetch(obj, ret, sysGetCachelineSize(), cid);
+	fetched = sysGetCachelineSize();
 	/* end   = sysGetTicks();
 	 * printf("fetch took %10u cc \n", end - start); */
 
+fetched:
+
 	/*
 	 * The object's Klass is always here and resides in the ROM so
 	 * there is no need for ext.ra fetches.
@@ -815,11 +2101,23 @@ sc_put(Address obj, int cid)
 	 */
 	/* int start, end;
 	 * start = sysGetTicks(); */
-	ret = block_to_oop(obj, ret, cid);
+	read_only = allow_ro && is_read_only(ret);
+	ret       = block_to_oop(obj, ret, cid, fetched, &read_only);
 	/* end   = sysGetTicks();
 	 * printf("block_to_oop takes %10u cc\n", end - start); */
 
 	/* Update the directory */
+	if (unlikely(read_only)) {
+		node = ro_insert((UWord)obj & SC_ADDRESS_MASK, (UWord)ret);
+		/* The space is there so there must be a free node as well */
+		assume(node != NULL);
+#ifdef SC_STATS
+		cacheROMisses_g++;
+#endif /* ifdef SC_STATS */
+
+		return node;
+	}
+
 	/* start = sysGetTicks(); */
 	node = dir_insert((UWord)obj & SC_ADDRESS_MASK, (UWord)ret);
 	/* end   = sysGetTicks();
@@ -833,7 +2131,23 @@ sc_put(Address obj, int cid)
 	/* sc_dump(); */
 
 	return node;
-}                  /* sc_put */
+}                  /* put */
+
+/**
+ * Fetches an object to cache it.  If cid is a positive number then
+ * the obj is fetched from that core's cache instead of the board's
+ * main memory.
+ *
+ * @param obj The object to cache
+ * @param cid  The core id to fetch it from
+ *
+ * @return The cached object
+ */
+sc_object_st*
+sc_put(Address obj, int cid)
+{
+	return put(obj, cid, 1);
+}
 
 /**
  * Looks up the cache to find the requested object. If it fails
@@ -848,12 +2162,35 @@ Address
 sc_get(Address obj, int is_write)
 {
 	sc_object_st *ret;
+	sc_object_st **memo;
 	Address      retval;
 
 	assume(is_write >> 1 == 0);
 
 	/* printf("Searching for %p\n", obj); */
 
+	/* Check the recently translated objects first */
+	memo = &cacheMemo_g[((UWord)obj >> 6) & (SC_MEMO_SIZE - 1)];
+	ret  = *memo;
+
+	if (likely(ret != NULL && ((ret->key ^ (UWord)obj) >> 6) == 0)) {
+#ifdef SC_STATS
+		cacheMemoHits_g++;
+#endif /* ifdef SC_STATS */
+
+		if (unlikely(is_ro_node(ret))) {
+			/* Writes never go to the read-only partition */
+			if (!is_write)
+				return (Address)ret->val;
+		}
+		else {
+			if (is_write)
+				dir_mark_dirty(ret);
+
+			return (Address)ret->val;
+		}
+	}
+
 	/* int start, end;
 	 * start = sysGetTicks(); */
 	/* Check if it is cached */
@@ -862,32 +2199,45 @@ sc_get(Address obj, int is_write)
 	 * printf("dir_lookup takes %10u cc\n", end - start); */
 
 	if (ret == NULL) { /* miss */
+		/*
+		 * Immutable objects are never written, so writes never go
+		 * to the read-only partition.
+		 */
+		if (!is_write && (ret = ro_lookup((UWord)obj)) != NULL) {
+#ifdef SC_STATS
+			cacheROHits_g++;
+#endif /* ifdef SC_STATS */
+			*memo = ret;
+
+			return (Address)ret->val;
+		}
+
+		/* Writes make our read-only copy stale, if we have one */
+		if (is_write)
+			ro_remove((UWord)obj & SC_ADDRESS_MASK);
+
 		/* printf(" %p not found\n", obj); */
 		/* Cache the object */
 		/* start = sysGetTicks(); */
-		ret = sc_put(obj, -1);
+		ret = put(obj, -1, !is_write);
 		/* end   = sysGetTicks();
 		 * printf("sc_put takes %10u cc\n", end - start); */
-	}
 
-	/* Address klass;
-	 * klass = (Address) * (int*)(ret->val & SC_ADDRESS_MASK);
-	 */
+		if (unlikely(is_ro_node(ret))) {
+			*memo = ret;
+
+			return (Address)ret->val;
+		}
 
-	/* If it is requested to be written and is not already marked as dirty */
-	if (is_write && !(ret->key & SC_DIRTY_MASK)) {
-		/* printf("Marked %p name = %s\n", obj,
-		 * com_sun_squawk_Klass_name(klass)); */
-		ret->key       |= is_write;
-		ret->next_dirty = cacheDirty_g;
-		cacheDirty_g    = ret;
+		/* Start fetching the objects it references */
+		prefetch_refs((Address)ret->val);
 	}
 
-	/* else if (is_write && (ret->key & SC_DIRTY_MASK)) {
-	 *  printf("Did not mark because it is dirty %p name = %s\n", obj,
-	 * com_sun_squawk_Klass_name(
-	 *             klass));
-	 * } */
+	*memo = ret;
+
+	/* If it is requested to be written mark it as dirty */
+	if (is_write)
+		dir_mark_dirty(ret);
 
 	retval = (Address)ret->val;
 
@@ -901,6 +2251,105 @@ sc_get(Address obj, int is_write)
 	return retval;
 }                  /* sc_get */
 
+/**
+ * Fetches a chunk of a chunked array and adds it to the cache.
+ *
+ * @param key   The global address of the chunk
+ * @param array The key of the chunk's array
+ * @param size  The number of bytes of the array in the chunk
+ *
+ * @return The directory record of the chunk
+ */
+static inline sc_object_st*
+chunk_put(UWord key, UWord array, int size)
+{
+	sc_prefetch_st *p;
+	Address        block;
+
+	/* If it is being prefetched, wait for it and use it */
+	if ((p = prefetch_lookup((Address)key)) != NULL) {
+		prefetch_poll(p, 1);
+		block  = p->block;
+		p->obj = NULL;
+#ifdef SC_STATS
+		cachePrefetchHits_g++;
+#endif /* ifdef SC_STATS */
+	}
+	else {
+		/*
+		 * Chunks always occupy a whole chunk (see write_back),
+		 * followed by their array's key
+		 */
+		block = challoc(SC_CHUNK_SIZE + sysGetCachelineSize());
+		fetch((Address)key, block, size, -1);
+	}
+
+	chunk_array(block) = array;
+
+#ifdef SC_STATS
+	cacheChunks_g++;
+#endif /* ifdef SC_STATS */
+
+	cacheChunkRecords_g++;
+
+	return dir_insert(key, (UWord)block | SC_CHUNK_FLAG);
+}
+
+/**
+ * Looks up the cache to find the chunk of an array holding the given
+ * offset.  If it fails (miss), it fetches it and adds it to the cache.
+ * Use sc_translate_at() that first checks whether the object is
+ * cacheable.
+ *
+ * @param obj      The array to get from the cache
+ * @param offset   The offset (in bytes) from obj that is going to be accessed
+ * @param is_write Whether it is going to be written after translation
+ *
+ * @return The base address to add offset to, valid only within the
+ *         chunk holding offset
+ */
+Address
+sc_get_chunk(Address obj, Offset offset, int is_write)
+{
+	sc_object_st *ret;
+	Address      oop;
+	UWord        key;
+	int          head, size, chunk;
+
+	oop = sc_get(obj, is_write);
+
+	/* Objects in the read-only partition are cached whole */
+	if (lo(oop, cacheStart_g) || hieq(oop, cacheEnd_g))
+		return oop;
+
+	/* The offset of oop from the start of its cache-line */
+	head = (UWord)oop & ~SC_ADDRESS_MASK;
+
+	/* Check if it is in the first chunk, or the whole object is here */
+	if (head + offset < SC_CHUNK_SIZE ||
+	    object_size_and_type(oop - head, &size) != 1 ||
+	    !is_chunked(oop - head, size + HDR_arrayHeaderSize))
+		return oop;
+
+	size += HDR_arrayHeaderSize;
+	chunk = (head + offset) / SC_CHUNK_SIZE;
+	assume(chunk * SC_CHUNK_SIZE < size);
+	key   = ((UWord)obj & SC_ADDRESS_MASK) + chunk * SC_CHUNK_SIZE;
+
+	ret = dir_lookup(key);
+
+	if (ret == NULL) /* miss */
+		ret = chunk_put(key, (UWord)obj & SC_ADDRESS_MASK,
+		                min(size - chunk * SC_CHUNK_SIZE, SC_CHUNK_SIZE));
+
+	/* If it is requested to be written mark it as dirty */
+	if (is_write)
+		dir_mark_dirty(ret);
+
+	return (Address)(ret->val & SC_ADDRESS_MASK) + head -
+	       chunk * SC_CHUNK_SIZE;
+}                  /* sc_get_chunk */
+
 /**
  * Looks up the cache to find the requested object and marks it as
  * dirty.  If it fails (miss), it first fetches it and adds it to the
@@ -911,45 +2360,46 @@ sc_get(Address obj, int is_write)
 void
 sc_mark_dirty(Address obj)
 {
-	UWord        key  = (UWord)obj;
-	int          i    = 1;
-	int          hash = dir_hash(key);
-	int          hash2;
-	sc_object_st *ret = &cacheDirectory_g[hash];
+	sc_object_st *ret;
 
 	/* printf("Marking %p\n", obj); */
 
-	/* If the first cell is not empty and id doesn't match */
-	if ((((ret->key ^ key) >> 6) != 0) && (ret->key)) {
-		hash2 = dir_hash2(key);
+	ret = dir_lookup((UWord)obj);
+	assume(ret);
+
+	/* If we find it and it is not marked already, we mark it */
+	dir_mark_dirty(ret);
+}
 
-		while (i < SC_HASHTABLE_SIZE) {
-			hash = (hash + hash2) % SC_HASHTABLE_SIZE;
-			ret  = &cacheDirectory_g[hash];
+/**
+ * Marks the cache lines holding [ea, ea+size) as dirty.  Use
+ * sc_mark_lines_dirty() that first checks whether ea is in the
+ * software cache.
+ *
+ * @param ea   The cached address that was written
+ * @param size The number of bytes written
+ */
+void
+sc_set_dirty_lines(Address ea, int size)
+{
+	int first, last;
 
-			/* Break if we find a match or an empty cell */
-			if ((((ret->key ^ key) >> 6) == 0) || (ret->key == NULL))
-				break;
+	assume(hieq(ea, cacheStart_g) && lo(ea, cacheEnd_g));
 
-			++i;
-		}
-	}
+	if (size <= 0)
+		return;
 
-	/* printf("i=%d key=%p\n", i, ret->key); */
-	assume(i < SC_HASHTABLE_SIZE && ret->key);
+	first = Address_diff(ea, cacheStart_g) / sysGetCachelineSize();
+	last  = (Address_diff(ea, cacheStart_g) + size - 1) / sysGetCachelineSize();
 
-	/* If we find it and it is not marked already, we mark it */
-	if (  /* (i < SC_HASHTABLE_SIZE) &&  */ !(ret->key & SC_DIRTY_MASK)) {
-		/* printf("Marked %p\n", obj); */
-		ret->key       |= 1;
-		assume(ret->next_dirty == NULL);
-		ret->next_dirty = cacheDirty_g;
-		cacheDirty_g    = ret;
+	for (; first <= last; ++first) {
+		cacheDirtyLines_g[first >> 5] |= 1U << (first & 31);
 	}
 }
 
 /**
- * Write-back object
+ * Write-back object.  For chunked arrays the cached chunks are written
+ * back as well.
  *
  * @param object the object to write back
  */
@@ -959,13 +2409,28 @@ sc_write_back(Address object)
 	sc_object_st *entry;
 	Address      cached;
 	UWord        obj = (UWord)object & SC_ADDRESS_MASK;
+	UWord        end;
+	int          size;
 
 	entry  = dir_lookup(obj);
 	assume(entry);
 	cached = entry->val & SC_ADDRESS_MASK;
 
 	/* kt_printf("to=%p from=%p\n", obj, cached); */
-	write_back(cached, obj);
+	write_back(cached, obj, 0);
+
+	if (object_size_and_type(cached, &size) == 1 &&
+	    is_chunked(cached, size + HDR_arrayHeaderSize)) {
+		end = obj + size + HDR_arrayHeaderSize;
+
+		for (entry = cachedObjects_g; entry; entry = entry->next_cached) {
+			if ((entry->val & SC_CHUNK_FLAG) &&
+			    hi((entry->key & SC_ADDRESS_MASK), obj) &&
+			    lo((entry->key & SC_ADDRESS_MASK), end))
+				write_back((Address)(entry->val & SC_ADDRESS_MASK),
+				           (Address)(entry->key & SC_ADDRESS_MASK), 1);
+		}
+	}
 
 	/* Force a hardware cache flush */
 	hwcache_flush();
@@ -973,6 +2438,102 @@ sc_write_back(Address object)
 	wait_pending_wb();
 }
 
+/**
+ * Drops our copy of an object, writing it back first if it is dirty,
+ * so that the next access fetches it from its home.  Its read-only
+ * copy, if any, is dropped as well.  For chunked arrays the cached
+ * chunks are dropped as well.
+ *
+ * Chunks may outlive their array's head in the cache, so they are
+ * found by the array's key they keep (see chunk_array).
+ *
+ * @param object the object to drop
+ */
+void
+sc_invalidate_object(Address object)
+{
+	sc_object_st   *node;
+	sc_object_st   *tmp;
+	sc_object_st   **prev;
+	sc_prefetch_st *p;
+	UWord          obj = (UWord)object & SC_ADDRESS_MASK;
+	int            i, size;
+	int            chunked;
+	int            dirty = 0;
+
+	if (object == NULL || !sc_in_heap(object) || !sc_is_cacheable(object))
+		return;
+
+	if ((p = prefetch_lookup(object)) != NULL)
+		prefetch_cancel(p);
+
+	/* Its chunks' prefetches might be stale as well */
+	for (i = 0; i < SC_PREFETCH_SLOTS; ++i) {
+		if (cachePrefetches_g[i].obj != NULL &&
+		    cachePrefetches_g[i].array == (Address)obj)
+			prefetch_cancel(&cachePrefetches_g[i]);
+	}
+
+	ro_remove(obj);
+
+	node = dir_lookup(obj);
+
+	chunked = cacheChunkRecords_g != 0;
+
+	/* Only the heads of chunked arrays have chunks to look for */
+	if (node != NULL &&
+	    (object_size_and_type((Address)(node->val & SC_ADDRESS_MASK),
+	                          &size) != 1 ||
+	     !is_chunked((Address)(node->val & SC_ADDRESS_MASK),
+	                 size + HDR_arrayHeaderSize)))
+		chunked = 0;
+
+	/* Most of the times it is not cached, avoid walking the list */
+	if (node == NULL && !chunked)
+		return;
+
+	prev = &cachedObjects_g;
+
+	while ((tmp = *prev)) {
+		/* Skip anything but the object and its chunks */
+		if (tmp != node &&
+		    (!(tmp->val & SC_CHUNK_FLAG) ||
+		     chunk_array(tmp->val & SC_ADDRESS_MASK) != obj)) {
+			prev = &tmp->next_cached;
+			continue;
+		}
+
+		if (tmp->key & SC_DIRTY_MASK) {
+			write_back((Address)(tmp->val & SC_ADDRESS_MASK),
+			           (Address)(tmp->key & SC_ADDRESS_MASK),
+			           tmp->val & SC_CHUNK_FLAG);
+			dirty = 1;
+		}
+
+		if (tmp->val & SC_CHUNK_FLAG)
+			cacheChunkRecords_g--;
+		else
+			node = NULL;
+
+		*prev            = tmp->next_cached;
+		tmp->next_cached = NULL;
+		tmp->key         = SC_DIR_TOMBSTONE;
+		tmp->val         = NULL;
+		cacheDirTombstones_g++;
+
+		/* Nothing else left to drop */
+		if (node == NULL && (!chunked || cacheChunkRecords_g == 0))
+			break;
+	}
+
+	if (dirty) {
+		dir_unlink_evicted_dirty();
+		wait_pending_wb();
+	}
+
+	dir_check_tombstones();
+}
+
 /**
  * Write-back any dirty objects in the software cache
  *
@@ -982,7 +2543,6 @@ sc_write_back(Address object)
 void
 sc_flush(int blocking)
 {
-	int          cnt;
 	sc_object_st *tmp;
 
 	/* printf("SC_FLUSH\n"); */
@@ -999,21 +2559,20 @@ sc_flush(int blocking)
 		UWord   cached = cacheDirty_g->val & SC_ADDRESS_MASK;
 		Address oop    = (Address)(cacheDirty_g->key & SC_ADDRESS_MASK);
 
-		/* TODO: Write-back only dirty cache lines not the whole object */
-		cnt =
-		    write_back((Address)cached,
-		               (Address)(((UWord)oop & 0x3FFFFC0) | MM_MB_HEAP_BASE));
+		/* Queue only the dirty cache lines of the object */
+		write_back((Address)cached, oop, cacheDirty_g->val & SC_CHUNK_FLAG);
 
-		/* FIXME cnt might be larger than 32 */
-		assume(cnt < 32);
-		/* Remove dirty bit and add cnt */
+		/* Remove dirty bit */
 		/* TODO: Should dirty bit be removed after completion? */
-		cacheDirty_g->key = (cacheDirty_g->key & SC_ADDRESS_MASK) | (cnt << 1);
+		cacheDirty_g->key = cacheDirty_g->key & SC_ADDRESS_MASK;
 		tmp               = cacheDirty_g;
 		cacheDirty_g      = cacheDirty_g->next_dirty;
 		tmp->next_dirty   = NULL;
 	}
 
+	/* Issue the remaining batch */
+	wb_issue();
+
 	/* Check if we need to wait for completion */
 	if (likely(blocking)) {
 		/* wait for the RDMAs to reach completion */
@@ -1099,9 +2658,9 @@ sc_dump()
 
 	printf("-------------------- CACHE DUMP START --------------------\n");
 
-	for (i = 0; i < SC_HASHTABLE_SIZE; ++i) {
-		if (cacheDirectory_g[i].val && cacheDirectory_g[i].val <
-		    (UWord)cacheAllocTop_g) {
+	for (i = 0; i < cacheDirBuckets_g * SC_BUCKET_NODES; ++i) {
+		if (cacheDirectory_g[i].val &&
+		    cacheDirectory_g[i].key != SC_DIR_TOMBSTONE) {
 			key = cacheDirectory_g[i].key & SC_ADDRESS_MASK;
 			val = cacheDirectory_g[i].val & SC_ADDRESS_MASK;
 			printf("%p cached @ %p\n", key, val);
@@ -1125,12 +2684,34 @@ sc_stats()
 #ifdef SC_STATS
 	printf("-------------------- CACHE DUMP STATS --------------------\n");
 
-	/* Counter for the number of flushes due to full cache. */
+	/* Counter for the number of flushes. */
 	printf(" Flushes: %10u\n", cacheFlushes_g);
 	/* Counts how many times the cache was cleared. */
 	printf(" Clears:  %10u\n", cacheClears_g);
 	/* Counter for the number of cached objects. */
 	printf(" Cached:  %10u\n", cacheObjects_g);
+	/* Counts how many times we had to evict a segment. */
+	printf(" Evicts:  %10u\n", cacheEvictions_g);
+	/* Counter for the number of evicted objects. */
+	printf(" Evicted: %10u\n", cacheEvictedObjects_g);
+	/* Counter for the number of objects invalidated on acquires. */
+	printf(" Invalid: %10u\n", cacheInvalidated_g);
+	/* Counters for the written back objects and the issued DMAs. */
+	printf(" WB objs: %10u\n", cacheWbObjects_g);
+	printf(" WB DMAs: %10u\n", cacheWbDMAs_g);
+	/* Counter for the number of array chunks fetched. */
+	printf(" Chunks:  %10u\n", cacheChunks_g);
+	/* Counter for the translations served by the memo. */
+	printf(" Memo:    %10u\n", cacheMemoHits_g);
+	/* Counters for the prefetches. */
+	printf(" PF sent: %10u\n", cachePrefetchIssued_g);
+	printf(" PF hits: %10u\n", cachePrefetchHits_g);
+	/* Counters for the read-only partition. */
+	printf(" RO hits: %10u\n", cacheROHits_g);
+	printf(" RO miss: %10u\n", cacheROMisses_g);
+	printf(" RO clrs: %10u\n", cacheROClears_g);
+	printf(" RO used: %10u/%u\n",
+	       SC_RO_SIZE - Address_diff(cacheROEnd_g, cacheROTop_g), SC_RO_SIZE);
 
 	printf("----------------------------------------------------------\n");
 #endif /* ifdef SC_STATS */
@@ -60,29 +60,186 @@ typedef struct sc_object sc_object_st;
 #define SC_ADDRESS_MASK ~((SC_CNT_MASK) | (SC_DIRTY_MASK))
 
 /**
- * The hash-table size must be the closest prime to the cache-lines
- * that can fit in the cache. To calculate this value use the
- * cache_memory/(cache_line_size+4*sizeof(void*)) formula and pass
- * the result to http://easycalculation.com/prime-number.php to find
- * the next smaller (nearest) prime number
+ * Key marking a directory node whose object was evicted.  Such nodes
+ * do not terminate the probe sequence on look-ups and can be reused
+ * on insertions.  Directory keys are cache-line aligned addresses, so
+ * a key made only of the SC_CNT_MASK bits is never a valid key.
  */
-#define SC_HASHTABLE_SIZE 85193
-#define SC_DIRECTORY_SIZE (SC_HASHTABLE_SIZE * (4 * sizeof(void*)))
-#define SC_CACHE_SIZE     (SC_HASHTABLE_SIZE * MM_CACHELINE_SIZE)
+#define SC_DIR_TOMBSTONE SC_CNT_MASK
+
+/**
+ * Look-ups of objects that are not cached have to probe past the
+ * tombstones, so when more than 1/SC_DIR_TOMBSTONE_RATIO of the
+ * directory nodes are tombstones the directory gets rehashed in place
+ * (see dir_rehash).  While rehashing, the nodes that still have to be
+ * reinserted are marked with SC_DIR_PENDING in their key.
+ */
+#define SC_DIR_TOMBSTONE_RATIO 4
+#define SC_DIR_PENDING         0x02
+
+/**
+ * When the cache gets full we evict the oldest objects, in FIFO
+ * order, at the granularity of a segment (1/SC_EVICT_SEGMENTS of the
+ * cache) instead of clearing the whole cache.
+ */
+#define SC_EVICT_SEGMENTS 8
+
+/**
+ * Each core has a software cache carve-out of SC_MAX_SIZE bytes.  The
+ * part actually used, all of it by default, can be set with the
+ * -Xsc:<bytes> option (but not below SC_MIN_SIZE).  At sc_initialize()
+ * it is split into a directory with at least one node per cache line,
+ * a bitmap of the dirty cache lines, the read-only partition and its
+ * directory, and the cache memory.
+ *
+ * The directory is a hash-table of a power of two buckets, each
+ * holding SC_BUCKET_NODES nodes of SC_NODE_SIZE bytes in a single
+ * cache line.  Collisions are resolved by probing the next buckets.
+ *
+ * SC_MAX_SIZE is the sum of these parts for a cache of SC_MAX_LINES
+ * cache lines: a directory of SC_MAX_BUCKETS buckets (the smallest
+ * power of two with a node per line), a bit per line, the read-only
+ * partition and its directory, the lines themselves, and three more
+ * lines lost to aligning the parts (see cache_lines).
+ */
+#define SC_BUCKET_NODES 4
+#define SC_NODE_SIZE    (4 * sizeof(void*))
+#define SC_MAX_LINES    85193
+#define SC_MAX_BUCKETS  32768
+#define SC_MAX_SIZE                                              \
+	((int)(SC_MAX_BUCKETS * SC_BUCKET_NODES * SC_NODE_SIZE +     \
+	       ((SC_MAX_LINES + 31) >> 5) * sizeof(unsigned int) +   \
+	       SC_RO_DIRECTORY_SIZE + SC_RO_SIZE +                   \
+	       (SC_MAX_LINES + 3) * MM_CACHELINE_SIZE))
+#define SC_MIN_SIZE     0x100000
+
+/**
+ * A small direct-mapped memo of the recently translated objects'
+ * directory nodes, checked before the directory.  Entries are
+ * validated against the node's key, so they never need invalidation.
+ */
+#define SC_MEMO_SIZE 16
+
+/**
+ * Write notices are kept as a bitmap of boards.  Each core records the
+ * boards it wrote to, and the notices it received with its acquires.
+ * They are cumulative, so that they carry the happens-before edges
+ * across monitors.  A release hands them to the monitor's manager,
+ * which replaces the monitor's notices with them; they already hold
+ * the notices of the monitor's previous releases, since we acquired
+ * it.  On acquires only the cached objects whose home is in the
+ * monitor's notices get invalidated.
+ */
+#define SC_NOTICE_WORDS 2
+
+/**
+ * Immutable objects (strings and instances of classes with only final
+ * fields) are kept in a separate read-only partition that survives
+ * clears and evictions.  Its directory has SC_RO_BUCKETS buckets, laid
+ * out and probed like the cache directory, with a node per cache line
+ * of the partition.  Records get dropped when their object is written
+ * and on acquires, like the rest of the cache, and the partition is
+ * cleared when it gets full.
+ */
+#define SC_RO_BUCKETS        1024
+#define SC_RO_LINES          (SC_RO_BUCKETS * SC_BUCKET_NODES)
+#define SC_RO_DIRECTORY_SIZE (SC_RO_LINES * SC_NODE_SIZE)
+#define SC_RO_SIZE           (SC_RO_LINES * MM_CACHELINE_SIZE)
+
+/**
+ * Prefetches are tracked in a small table of in-flight fetches that is
+ * consulted on misses.  When all slots are taken the oldest prefetch
+ * gets dropped.  After a miss up to SC_PREFETCH_FIELDS references of
+ * the fetched object are prefetched as well.
+ */
+#define SC_PREFETCH_SLOTS  16
+#define SC_PREFETCH_FIELDS 4
+
+/**
+ * An in-flight prefetch
+ */
+typedef struct sc_prefetch {
+	Address obj;   /**< The prefetched object or NULL if the slot is
+	                * free */
+	Address block; /**< The cache memory it is fetched to */
+	Address array; /**< The array of a prefetched chunk, NULL for
+	                * objects */
+	int     size;  /**< The number of bytes being fetched */
+	int     whole; /**< Whether size covers the whole object or only
+	                * its first cache line */
+	int     cnt;   /**< The ack counter or -1 if the fetch completed */
+} sc_prefetch_st;
+
+/**
+ * Arrays larger than SC_CHUNK_SIZE bytes (including their header) are
+ * cached in chunks of SC_CHUNK_SIZE bytes, fetched on demand.  The
+ * first chunk, holding the header, is the array's own directory
+ * record.  The rest are keyed by the global address they start at,
+ * which is never the key of another object, and their records have
+ * SC_CHUNK_FLAG set in their value.  Each chunk is followed by a cache
+ * line holding its array's key, so that the chunks can be found
+ * without the array's head.  Read-only arrays are chunked only if they
+ * do not fit in the read-only partition.
+ */
+#define SC_CHUNK_SIZE 4096
+#define SC_CHUNK_FLAG 0x01
+
+/**
+ * Dirty runs are queued for write-back and issued in batches of up to
+ * SC_WB_BATCH runs sharing a single acknowledgment counter.  Runs that
+ * are adjacent both in the cache and at their home are merged into a
+ * single DMA of up to SC_WB_MAX_DMA bytes, the upper limit for a DMA
+ * transfer.
+ */
+#define SC_WB_BATCH   64
+#define SC_WB_MAX_DMA 0x100000
+
+/**
+ * A queued write-back run
+ */
+typedef struct sc_wb_run {
+	Address from; /**< The cached copy of the run */
+	Address to;   /**< The (global) home address of the run */
+	int     size; /**< The size of the run in bytes */
+} sc_wb_run_st;
 
 /* The size of a Klass object instance (72) rounded up to cache line size */
 #define SC_KLASS_SIZE 128
 
-void        sc_initialize();
+void        sc_initialize(int size);
 Address     sc_get(Address obj, int is_write);
 void        sc_mark_dirty(Address obj);
+void        sc_set_dirty_lines(Address ea, int size);
 void        sc_write_back(Address object);
+void        sc_invalidate_object(Address object);
 void        sc_flush(int blocking);
 void        sc_clear();
+void        sc_invalidate(unsigned int *notices);
+void        sc_prefetch(Address obj);
+void        sc_prefetch_range(Address array, int from, int to);
+void        sc_prefetch_progress();
+Address     sc_get_chunk(Address obj, Offset offset, int is_write);
 void        sc_dump();
 void        sc_stats();
 sc_object_st* sc_put(Address obj, int cid);
 
+/**
+ * Marks the cache lines holding [ea, ea+size) as dirty if ea is a
+ * cached copy of a remote object.  Only the dirty lines of an object
+ * are written back to its home.
+ *
+ * NOTE: This is a macro because the globals are not yet defined at
+ * this point.
+ *
+ * @param ea   The (translated) address that was written
+ * @param size The number of bytes written
+ */
+#define sc_mark_lines_dirty(ea, size)                                      \
+	do {                                                                   \
+		if (unlikely(hieq((ea), cacheStart_g) && lo((ea), cacheEnd_g)))    \
+			sc_set_dirty_lines((Address)(ea), (size));                     \
+	} while (0)
+
 /**
  * Checks if an address is in the heap address space.  Heap addresses
  * have at least one of their 6 MSBs set.
@@ -167,9 +324,6 @@ sc_translate(Address obj, int is_write)
 		/* printf("%p is cacheable\n", obj); */
 
 		/* It is cacheable, get it from the cache */
-
-		/* TODO: Improve performance by marking as dirty only cachelines and
-		 * not the whole object. */
 		return sc_get(obj, is_write);
 	}
 	else {
@@ -184,6 +338,29 @@ sc_translate(Address obj, int is_write)
 	}
 }
 
+/**
+ * Like sc_translate but for accessing the byte at the given offset of
+ * the object.  If it is a chunked array, the returned base address is
+ * only valid for accesses within the chunk holding that offset (see
+ * SC_CHUNK_SIZE).
+ *
+ * @param obj      The object to check
+ * @param offset   The offset (in bytes) from obj that is going to be accessed
+ * @param is_write Whether it is going to be written after translation
+ *
+ * @return the base address to add offset to
+ */
+INLINE Address
+sc_translate_at(Address obj, Offset offset, int is_write)
+{
+	/* The header and the first elements are always in the first chunk */
+	if (likely(offset < SC_CHUNK_SIZE - MM_CACHELINE_SIZE) || obj == NULL ||
+	    !sc_in_heap(obj) || !sc_is_cacheable(obj))
+		return sc_translate(obj, is_write);
+
+	return sc_get_chunk(obj, offset, is_write);
+}
+
 /**
  * Takes an address and prefixes it with the caller's board id
  *